@@ -0,0 +1,177 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <algorithm>    // std::max, std::min
+#include <atomic>
+#include <cstddef>      // std::size_t, std::max_align_t
+#include <cstdint>      // std::uintptr_t
+#include <cstdio>       // std::fprintf
+#include <cstdlib>      // std::abort
+#include <new>          // ::operator new, placement new
+#include <string>
+#include <type_traits>  // std::is_trivially_destructible
+#include <utility>      // std::forward
+#include "SharedPtr.h"
+#include "TypeName.h"
+
+// =============================== Arena ===============================
+// Per-request bump allocator for object graphs that die together.
+// make_arena_shared<T>(arena, args...) places block and object in the
+// arena; the last release only runs ~T() (nothing at all for trivially
+// destructible T) and the memory comes back in one piece when the arena
+// is reset or destroyed.
+//
+// Allocation is single-threaded, like a pool's acquire(); handles may be
+// copied and released on any thread, but every one of them must be gone
+// (and that must happen-before) reset() or ~Arena().  With
+// SHPTR_ARENA_DEBUG (on unless NDEBUG) the arena links a small record per
+// object and checks that: a handle still alive at that point has escaped
+// the arena's lifetime, so the arena prints the escaped types to stderr
+// and aborts instead of freeing memory that is still referenced.
+
+#ifndef SHPTR_ARENA_DEBUG
+  #ifdef NDEBUG
+    #define SHPTR_ARENA_DEBUG 0
+  #else
+    #define SHPTR_ARENA_DEBUG 1
+  #endif
+#endif
+
+namespace detail {
+#if SHPTR_ARENA_DEBUG
+    struct ArenaRecord {
+        ArenaRecord*      next = nullptr;
+        std::string     (*type)() = nullptr;
+        std::atomic<bool> dead{false};          // set by the dispose hook
+    };
+#endif
+
+    template<class T>
+    struct ArenaBlock : HookedBlock<T*> {
+#if SHPTR_ARENA_DEBUG
+        ArenaRecord record;
+#endif
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        ArenaBlock() noexcept : HookedBlock<T*>(reinterpret_cast<T*>(storage), &dispose) {}
+        // memory stays in the arena; only the destructor runs here
+        static void dispose(ControlBlock<T*>* cb) noexcept {
+            if(!std::is_trivially_destructible<T>::value) cb->ptr->~T();
+#if SHPTR_ARENA_DEBUG
+            static_cast<ArenaBlock*>(cb)->record.dead.store(true, std::memory_order_release);
+#endif
+        }
+    };
+}
+
+class Arena {
+public:
+    explicit Arena(std::size_t chunk_bytes = 64 * 1024) noexcept
+        : first_(std::max<std::size_t>(chunk_bytes, 256)), next_(first_) {}
+    ~Arena() { check_escapes(); free_chunks(nullptr); }
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // Frees everything at once.  The newest chunk is kept for reuse.
+    void reset() {
+        check_escapes();
+        free_chunks(head_);
+        if(head_){ cur_ = data(head_); end_ = cur_ + head_->size; }
+        used_ = 0;
+    }
+
+    // Raw bump allocation; align must be a power of two.
+    void* allocate(std::size_t bytes, std::size_t align) {
+        char* p = align_up(cur_, align);
+        // aligning may step past end_: test that before the remaining size
+        if(!cur_ || p > end_ || bytes > static_cast<std::size_t>(end_ - p)) { grow(bytes + align); p = align_up(cur_, align); }
+        cur_ = p + bytes;
+        used_ += bytes;
+        return p;
+    }
+
+    std::size_t bytes_used()     const noexcept { return used_; }
+    std::size_t bytes_reserved() const noexcept { return reserved_; }
+
+#if SHPTR_ARENA_DEBUG
+    // Objects whose last handle has not been released yet.
+    std::size_t live() const noexcept {
+        std::size_t n = 0;
+        for(const detail::ArenaRecord* r = records_; r; r = r->next)
+            n += !r->dead.load(std::memory_order_acquire);
+        return n;
+    }
+#endif
+
+private:
+    struct Chunk {
+        Chunk*      next;
+        std::size_t size;               // usable bytes after the header
+    };
+    static constexpr std::size_t kMaxChunk = 1u << 20;
+
+    Chunk*      head_ = nullptr;        // newest first
+    char*       cur_  = nullptr;
+    char*       end_  = nullptr;
+    std::size_t first_, next_;
+    std::size_t used_ = 0, reserved_ = 0;
+#if SHPTR_ARENA_DEBUG
+    detail::ArenaRecord* records_ = nullptr;
+#endif
+
+    template<class T, class... Args> friend SharedPtr<T> make_arena_shared(Arena&, Args&&...);
+
+    static char* data(Chunk* c) noexcept { return reinterpret_cast<char*>(c) + sizeof(Chunk); }
+    static char* align_up(char* p, std::size_t a) noexcept {
+        return reinterpret_cast<char*>((reinterpret_cast<std::uintptr_t>(p) + a - 1) & ~std::uintptr_t(a - 1));
+    }
+
+    void grow(std::size_t need) {
+        const std::size_t size = std::max(next_, need);
+        Chunk* c = static_cast<Chunk*>(::operator new(sizeof(Chunk) + size));
+        c->next = head_; c->size = size;
+        head_ = c; cur_ = data(c); end_ = cur_ + size;
+        reserved_ += size;
+        next_ = std::min(next_ * 2, std::max(kMaxChunk, first_));
+    }
+    // frees every chunk but `keep`
+    void free_chunks(Chunk* keep) noexcept {
+        Chunk* c = head_;
+        while(c){ Chunk* nx = c->next; if(c!=keep) ::operator delete(c); c = nx; }
+        head_ = keep;
+        if(keep){ keep->next = nullptr; reserved_ = keep->size; }
+        else    { cur_ = end_ = nullptr; reserved_ = 0; }
+#if SHPTR_ARENA_DEBUG
+        records_ = nullptr;
+#endif
+    }
+
+    void check_escapes() noexcept {
+#if SHPTR_ARENA_DEBUG
+        const std::size_t escaped = live();
+        if(!escaped) return;
+        std::fprintf(stderr, "Arena at %p: %zu object(s) still owned by a SharedPtr, e.g.\n", static_cast<void*>(this), escaped);
+        std::size_t shown = 0;
+        for(const detail::ArenaRecord* r = records_; r && shown < 16; r = r->next)
+            if(!r->dead.load(std::memory_order_acquire)) { std::fprintf(stderr, "  %s\n", r->type().c_str()); ++shown; }
+        std::abort();
+#endif
+    }
+};
+
+// Builds a T in the arena.  The block is hooked, so the handle is an
+// ordinary SharedPtr<T> and mixes with heap-backed ones.
+template<class T, class... Args>
+SharedPtr<T> make_arena_shared(Arena& arena, Args&&... args) {
+    using Block = detail::ArenaBlock<T>;
+    Block* b = ::new (arena.allocate(sizeof(Block), alignof(Block))) Block();
+    ::new (static_cast<void*>(b->storage)) T(std::forward<Args>(args)...);   // on throw the bytes just stay unused
+#if SHPTR_ARENA_DEBUG
+    b->record.type = &detail::type_name<T>;
+    b->record.next = arena.records_;
+    arena.records_ = &b->record;
+#endif
+    return detail::SharedPtrAccess::adopt<SharedPtr<T>>(detail::accounted<T>(b, false, 0, sizeof(Block) - sizeof(T)));
+}
+
+#endif // ARENA_H
@@ -0,0 +1,206 @@
+#ifndef ASYNC_RELEASE_H
+#define ASYNC_RELEASE_H
+
+#if !defined(__cpp_impl_coroutine) && !defined(__cpp_coroutines)
+  #error "AsyncRelease.h needs C++20 coroutines (-std=c++20)"
+#endif
+
+#include <coroutine>
+#include <cstddef>      // std::size_t
+#include <deque>
+#include <exception>    // std::terminate
+#include <functional>   // std::function
+#include <memory>       // std::unique_ptr
+#include <mutex>
+#include <unordered_map>
+#include <utility>      // std::move
+#include "SharedPtr.h"
+
+// ====================== Coroutines and last release ==================
+// co_await when_released(std::move(p)) gives up p's reference and resumes
+// the coroutine after the last owner has released the object (destructor
+// or deleter done, block freed).  It resumes on the thread that dropped
+// the last reference, or on `executor` when one is passed.  The parked
+// coroutine holds no reference, so waiting cannot keep the object alive.
+//
+// async_deleter(executor, f) makes a deleter for SharedPtr(p, d) whose
+// call from the last release only posts f(p) to the executor; f can be a
+// coroutine (DetachedTask) that flushes or closes before freeing p.  A
+// when_released() on such a pointer resumes once the cleanup is posted,
+// not when it finishes.
+//
+// An executor is anything with post(std::function<void()>);
+// SingleThreadExecutor is a minimal one for tests and tools.
+
+// Fire-and-forget coroutine: starts at once, frees its frame when done.
+// An escaping exception terminates, as it would from a destructor.
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask        get_return_object() noexcept { return {}; }
+        std::suspend_never  initial_suspend() noexcept { return {}; }
+        std::suspend_never  final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+// Posting may happen from any thread; run() and run_one() execute the
+// queued work on the calling thread, in FIFO order.
+class SingleThreadExecutor {
+public:
+    void post(std::function<void()> f) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(std::move(f));
+    }
+    // Runs one queued item; false if there was none.
+    bool run_one() {
+        std::function<void()> f;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if(queue_.empty()) return false;
+            f = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        f();
+        return true;
+    }
+    // Runs until the queue is empty, including work posted meanwhile.
+    std::size_t run() { std::size_t n = 0; while(run_one()) ++n; return n; }
+    std::size_t pending() const { std::lock_guard<std::mutex> lock(mutex_); return queue_.size(); }
+
+    // co_await ex.schedule() continues the coroutine on this executor.
+    auto schedule() noexcept {
+        struct Awaiter {
+            SingleThreadExecutor* ex;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> h) { ex->post([h] { h.resume(); }); }
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{this};
+    }
+
+private:
+    mutable std::mutex                mutex_;
+    std::deque<std::function<void()>> queue_;
+};
+
+namespace detail {
+    struct ReleaseWaiter {
+        ReleaseWaiter*          next;
+        std::coroutine_handle<> handle;
+        void (*post)(void* executor, std::coroutine_handle<> h) noexcept;   // null: resume inline
+        void*                   executor;
+    };
+    struct ReleaseWaiterTable {
+        std::mutex                                       mutex;
+        std::unordered_map<const void*, ReleaseWaiter*>  parked;    // block -> waiters
+    };
+    // Leaked on purpose: final releases still run during static destruction.
+    inline ReleaseWaiterTable& release_waiter_table() { static ReleaseWaiterTable* t = new ReleaseWaiterTable; return *t; }
+
+    inline void* take_release_waiters(const void* cb) noexcept {
+        ReleaseWaiterTable& t = release_waiter_table();
+        std::lock_guard<std::mutex> lock(t.mutex);
+        auto it = t.parked.find(cb);
+        if(it==t.parked.end()) return nullptr;
+        ReleaseWaiter* w = it->second;
+        t.parked.erase(it);
+        if(!kParked) parked_blocks.fetch_sub(1, std::memory_order_relaxed);
+        return w;
+    }
+    inline void resume_release_waiters(void* list) noexcept {
+        for(ReleaseWaiter* w = static_cast<ReleaseWaiter*>(list); w; ) {
+            const ReleaseWaiter c = *w;
+            delete w;
+            if(c.post) c.post(c.executor, c.handle);
+            else       c.handle.resume();
+            w = c.next;
+        }
+    }
+    inline constexpr ReleaseWaiterHooks kReleaseWaiterHooks{&take_release_waiters, &resume_release_waiters};
+
+    // Parks `w` until `cb` dies.  The caller still owns a reference, so the
+    // block cannot die meanwhile.  The first waiter sets kParked (or counts
+    // the block in parked_blocks, on 32-bit words), which only the final
+    // release reads, so other releases do not slow down.
+    template<class P>
+    void park_until_released(ControlBlock<P>* cb, ReleaseWaiter w) {
+        std::unique_ptr<ReleaseWaiter> node(new ReleaseWaiter(w));
+        release_waiter_hooks.store(&kReleaseWaiterHooks, std::memory_order_release);
+        ReleaseWaiterTable& t = release_waiter_table();
+        std::lock_guard<std::mutex> lock(t.mutex);
+        ReleaseWaiter*& head = t.parked[cb];     // may throw before anything changed
+        const bool first = head==nullptr;
+        node->next = head;
+        head = node.release();
+        if(!first) return;
+        if(!kParked) { parked_blocks.fetch_add(1, std::memory_order_relaxed); return; }
+#ifdef SHPTR_THREADSAFE
+        cb->ref_cnt.fetch_or(kParked, std::memory_order_release);
+#else
+        cb->ref_cnt |= kParked;
+#endif
+    }
+
+    template<class Ex>
+    void post_resume(void* ex, std::coroutine_handle<> h) noexcept {
+        try { static_cast<Ex*>(ex)->post([h] { h.resume(); }); }
+        catch(...) { h.resume(); }                // could not queue: resume here
+    }
+
+    template<class Ex, class F>
+    struct AsyncDeleter {
+        Ex* executor;
+        F   cleanup;
+        template<class P>
+        void operator()(P p) const noexcept {
+            try { executor->post([f = cleanup, p]() mutable { f(p); }); }
+            catch(...) { F f = cleanup; f(p); }    // could not queue: clean up here
+        }
+    };
+}
+
+// Awaitable returned by when_released(); S is SharedPtr<T> or SharedPtr<T[]>.
+template<class S>
+class ReleaseAwaiter {
+public:
+    ReleaseAwaiter(S p, void (*post)(void*, std::coroutine_handle<>) noexcept, void* executor) noexcept
+        : p_(std::move(p)), post_(post), executor_(executor) {}
+
+    bool await_ready() const noexcept { return !p_; }
+    bool await_suspend(std::coroutine_handle<> h) {
+        if(p_.use_count()==1) {                               // sole owner: released right here
+            p_.reset();
+            if(!post_) return false;
+            post_(executor_, h);
+            return true;
+        }
+        detail::park_until_released(detail::SharedPtrAccess::block(p_), {nullptr, h, post_, executor_});
+        S last = std::move(p_);
+        last.reset();            // may resume h before returning; *this is not touched after
+        return true;
+    }
+    void await_resume() const noexcept {}
+
+private:
+    S     p_;
+    void (*post_)(void*, std::coroutine_handle<>) noexcept;
+    void* executor_;
+};
+
+// Drops p and resumes once the object it shares has been released.
+template<class T>
+ReleaseAwaiter<SharedPtr<T>> when_released(SharedPtr<T> p) noexcept { return {std::move(p), nullptr, nullptr}; }
+
+// As above, resuming on `ex` (any type with post(std::function<void()>)).
+template<class T, class Ex>
+ReleaseAwaiter<SharedPtr<T>> when_released(SharedPtr<T> p, Ex& ex) noexcept {
+    return {std::move(p), &detail::post_resume<Ex>, &ex};
+}
+
+// Deleter for SharedPtr(p, d): the last release posts f(p) to `ex` and
+// returns.  If posting fails, f(p) runs on the releasing thread.
+template<class Ex, class F>
+detail::AsyncDeleter<Ex, F> async_deleter(Ex& ex, F f) { return {&ex, std::move(f)}; }
+
+#endif // ASYNC_RELEASE_H
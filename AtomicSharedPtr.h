@@ -0,0 +1,140 @@
+#ifndef ATOMIC_SHARED_PTR_H
+#define ATOMIC_SHARED_PTR_H
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>      // std::uint64_t, std::uintptr_t
+#include <type_traits>  // std::remove_pointer_t
+#include <utility>      // std::move, std::declval
+#include "SharedPtr.h"
+
+#ifndef SHPTR_THREADSAFE
+  #error "AtomicSharedPtr.h needs the atomic counter (-DSHPTR_THREADSAFE)"
+#endif
+
+// =========================== AtomicSharedPtr =========================
+// A SharedPtr<T> slot that threads may load, store, exchange and CAS
+// concurrently, lock-free, using split reference counts.  The slot is
+// one 64-bit word: the control-block pointer in the low 48 bits and a
+// local count of in-flight loads in the top 16.
+//
+// load() bumps the local count with a single fetch_add.  That pins the
+// block, so the load can safely take a real reference.  It then gives
+// the local unit back with a CAS.  A store that swaps the block out
+// first moves the outstanding local units into the block's own count.
+// A load that finds its block gone drops that unit with an ordinary
+// release.  If the same block comes back, the units are interchangeable,
+// so that ABA case balances out too.
+//
+// Needs 64-bit pointers with 48 significant bits (x86-64, AArch64
+// without 52/57-bit user addresses).  At most 65535 loads may be in
+// flight on one slot at a time.
+
+template<class T>
+class AtomicSharedPtr {
+    using S     = SharedPtr<T>;
+    using Block = std::remove_pointer_t<decltype(detail::SharedPtrAccess::block(std::declval<const S&>()))>;
+
+    static constexpr unsigned      kPtrBits  = 48;
+    static constexpr std::uint64_t kPtrMask  = (std::uint64_t(1) << kPtrBits) - 1;
+    static constexpr std::uint64_t kLocalOne = std::uint64_t(1) << kPtrBits;
+    static_assert(sizeof(void*)==8, "AtomicSharedPtr packs a 48-bit pointer into a 64-bit word");
+
+public:
+    AtomicSharedPtr() noexcept : word_(0) {}
+    AtomicSharedPtr(S p) noexcept : word_(pack(detail::SharedPtrAccess::detach(p))) {}
+    ~AtomicSharedPtr() { take(word_.load(std::memory_order_acquire)); }
+    AtomicSharedPtr(const AtomicSharedPtr&) = delete;
+    AtomicSharedPtr& operator=(const AtomicSharedPtr&) = delete;
+
+    static constexpr bool is_always_lock_free = std::atomic<std::uint64_t>::is_always_lock_free;
+
+    S load() const noexcept {
+        const std::uint64_t w = word_.fetch_add(kLocalOne, std::memory_order_acquire) + kLocalOne;
+        Block* cb = block_of(w);
+        S out;
+        if(cb) {
+            detail::retain(cb);
+            out = detail::SharedPtrAccess::adopt<S>(cb);
+        }
+        give_back(w);
+        return out;
+    }
+    operator S() const noexcept { return load(); }
+
+    // Calls f(p) with p the current pointer (null if empty) while the block
+    // is pinned by the local count, without taking a reference: two RMWs on
+    // the slot instead of load()'s three plus a release.  f must not keep p
+    // past its return.
+    template<class F>
+    decltype(auto) visit(F&& f) const {
+        const std::uint64_t w = word_.fetch_add(kLocalOne, std::memory_order_acquire) + kLocalOne;
+        struct Unpin {
+            const AtomicSharedPtr* slot; std::uint64_t w;
+            ~Unpin() { slot->give_back(w); }
+        } unpin{this, w};
+        Block* cb = block_of(w);
+        return f(cb ? cb->ptr : nullptr);
+    }
+
+    void store(S desired) noexcept { exchange(std::move(desired)); }
+    AtomicSharedPtr& operator=(S desired) noexcept { store(std::move(desired)); return *this; }
+
+    S exchange(S desired) noexcept {
+        const std::uint64_t w = word_.exchange(pack(detail::SharedPtrAccess::detach(desired)), std::memory_order_acq_rel);
+        return take(w);
+    }
+
+    // Succeeds if the slot still holds expected's block; otherwise loads
+    // the current value into `expected`.  On success `desired` is moved in.
+    bool compare_exchange_strong(S& expected, S desired) noexcept {
+        Block* const want = detail::SharedPtrAccess::block(expected);
+        std::uint64_t w = word_.load(std::memory_order_relaxed);
+        while(block_of(w)==want) {
+            // local counts may change under us; only the block matters
+            if(word_.compare_exchange_weak(w, pack(detail::SharedPtrAccess::block(desired)),
+                                           std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                detail::SharedPtrAccess::detach(desired);
+                take(w);                           // the slot's old reference goes away
+                return true;
+            }
+        }
+        expected = load();
+        return false;
+    }
+    bool compare_exchange_weak(S& expected, S desired) noexcept { return compare_exchange_strong(expected, std::move(desired)); }
+
+    bool is_lock_free() const noexcept { return word_.is_lock_free(); }
+
+private:
+    mutable std::atomic<std::uint64_t> word_;
+
+    static std::uint64_t pack(Block* cb) noexcept {
+        const auto bits = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(cb));
+        assert((bits & ~kPtrMask)==0 && "control block above the 48-bit address range");
+        return bits;
+    }
+    static Block* block_of(std::uint64_t w) noexcept { return reinterpret_cast<Block*>(static_cast<std::uintptr_t>(w & kPtrMask)); }
+
+    // Returns a load's local unit.  If the slot has moved on, the store
+    // that replaced our block converted the unit into a real reference.
+    void give_back(std::uint64_t w) const noexcept {
+        Block* const cb = block_of(w);
+        while(block_of(w)==cb && (w & ~kPtrMask)!=0) {
+            if(word_.compare_exchange_weak(w, w - kLocalOne, std::memory_order_release, std::memory_order_relaxed)) return;
+        }
+        if(cb) detail::SharedPtrAccess::adopt<S>(cb).reset();
+    }
+
+    // Turns a word swapped out of the slot into a SharedPtr owning the
+    // slot's reference, after crediting the block with the loads still
+    // in flight on it (each of them releases one when it notices).
+    static S take(std::uint64_t w) noexcept {
+        Block* cb = block_of(w);
+        if(!cb) return S();
+        if(const std::uint64_t pending = w >> kPtrBits) cb->ref_cnt.fetch_add(static_cast<ref_value_t>(pending), std::memory_order_relaxed);
+        return detail::SharedPtrAccess::adopt<S>(cb);
+    }
+};
+
+#endif // ATOMIC_SHARED_PTR_H
@@ -0,0 +1,209 @@
+#ifndef CONCURRENT_MAP_H
+#define CONCURRENT_MAP_H
+
+#include <atomic>
+#include <cstddef>      // std::size_t
+#include <cstdint>      // std::uint64_t
+#include <functional>   // std::hash, std::equal_to
+#include <memory>       // std::allocator, std::unique_ptr
+#include <mutex>
+#include <utility>      // std::pair, std::move
+#include <vector>
+#include "AtomicSharedPtr.h"
+
+// =========================== ConcurrentMap ===========================
+// Hash map from K to SharedPtr<V> for read-mostly caches.  find() takes
+// no lock: a plain acquire load of the shard's table, one bucket chain
+// pinned through AtomicSharedPtr (two RMWs on the slot), and a copy of
+// the value's SharedPtr.  Chains are immutable.  A writer takes its
+// shard's mutex, builds the changed chain and publishes it.  New keys are
+// prepended, so an insert copies nothing.  A full shard builds a table of
+// twice the size and empties the old one, which stays allocated for late
+// readers.
+//
+// A reader that loaded a chain keeps it, and therefore every value in it,
+// alive.  An erased or replaced value is destroyed only when the last
+// reader, old bucket or returned handle drops it, never under a lock.
+// Needs SHPTR_THREADSAFE (AtomicSharedPtr).
+
+template<class K, class V, class Hash = std::hash<K>, class Eq = std::equal_to<K>>
+class ConcurrentMap {
+public:
+    using Value = SharedPtr<V>;
+
+private:
+    // Bucket chains are immutable: a write rebuilds the nodes in front of
+    // the one it changes and shares the rest.
+    struct Node {
+        K               key;
+        Value           value;
+        SharedPtr<Node> next;
+        Node(const K& k, Value v, SharedPtr<Node> n) : key(k), value(std::move(v)), next(std::move(n)) {}
+    };
+    struct Table {
+        std::size_t                                 mask;
+        std::unique_ptr<AtomicSharedPtr<Node>[]>    slots;
+        std::atomic<bool>                           retired{false};   // replaced by a bigger table
+        explicit Table(std::size_t n) : mask(n - 1), slots(new AtomicSharedPtr<Node>[n]) {}
+    };
+    struct alignas(64) Shard {
+        std::mutex                          writer;
+        std::atomic<Table*>                 table{nullptr};
+        std::atomic<std::size_t>            size{0};
+        std::vector<std::unique_ptr<Table>> tables;     // current last; older ones may still be read
+    };
+    static constexpr std::size_t kMaxLoad = 2;      // entries per bucket before a shard grows
+
+public:
+    // Both counts are rounded up to powers of two.
+    explicit ConcurrentMap(std::size_t shards = 64, std::size_t buckets_per_shard = 16, Hash hash = Hash(), Eq eq = Eq())
+        : shard_bits_(log2_ceil(shards)), shards_(new Shard[std::size_t(1) << shard_bits_]),
+          hash_(std::move(hash)), eq_(std::move(eq)) {
+        const std::size_t n = std::size_t(1) << log2_ceil(buckets_per_shard);
+        for(std::size_t i = 0; i < shard_count(); ++i) shards_[i].table.store(add_table(shards_[i], n), std::memory_order_release);
+    }
+    ConcurrentMap(const ConcurrentMap&) = delete;
+    ConcurrentMap& operator=(const ConcurrentMap&) = delete;
+
+    // The value for k, or null.  Lock-free: the chain head is only pinned
+    // (AtomicSharedPtr::visit) and keeps the nodes behind it alive while
+    // they are walked.  A miss in a table that has since been replaced is
+    // retried in the new one.
+    Value find(const K& k) const {
+        const std::uint64_t h = mix(k);
+        const Shard& s = shard(h);
+        for(;;) {
+            const Table* t = s.table.load(std::memory_order_acquire);
+            Value v = t->slots[h & t->mask].visit([&](const Node* n) {
+                for(; n; n = n->next.get()) if(eq_(n->key, k)) return n->value;
+                return Value();
+            });
+            if(v || !t->retired.load(std::memory_order_acquire)) return v;
+        }
+    }
+    bool contains(const K& k) const { return static_cast<bool>(find(k)); }
+
+    // Adds k -> v unless k is present; true if added.
+    bool insert(const K& k, Value v) { return put(k, std::move(v), false); }
+    // Adds or replaces; true if k was new.  A replaced value lives on in
+    // its readers' handles.
+    bool insert_or_assign(const K& k, Value v) { return put(k, std::move(v), true); }
+
+    // Removes k and returns its value (null if absent).
+    Value erase(const K& k) {
+        const std::uint64_t h = mix(k);
+        Shard& s = shard(h);
+        SharedPtr<Node> head;                       // the old chain dies after unlocking
+        std::lock_guard<std::mutex> lock(s.writer);
+        Table* t = s.table.load(std::memory_order_relaxed);
+        AtomicSharedPtr<Node>& slot = t->slots[h & t->mask];
+        head = slot.load();
+        const Node* hit = head.get();
+        while(hit && !eq_(hit->key, k)) hit = hit->next.get();
+        if(!hit) return Value();
+        Value out = hit->value;
+        slot.store(relink(head.get(), hit, hit->next));
+        s.size.fetch_sub(1, std::memory_order_relaxed);
+        return out;
+    }
+
+    void clear() {
+        for(std::size_t i = 0; i < shard_count(); ++i) {
+            std::vector<SharedPtr<Node>> chains;    // released after unlocking
+            Shard& s = shards_[i];
+            std::lock_guard<std::mutex> lock(s.writer);
+            Table* t = s.table.load(std::memory_order_relaxed);
+            chains.reserve(t->mask + 1);
+            for(std::size_t j = 0; j <= t->mask; ++j)
+                if(SharedPtr<Node> c = t->slots[j].exchange(SharedPtr<Node>())) chains.push_back(std::move(c));
+            s.size.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // approximate under concurrency
+    std::size_t size() const noexcept {
+        std::size_t n = 0;
+        for(std::size_t i = 0; i < shard_count(); ++i) n += shards_[i].size.load(std::memory_order_relaxed);
+        return n;
+    }
+    std::size_t shard_count() const noexcept { return std::size_t(1) << shard_bits_; }
+
+private:
+    const unsigned           shard_bits_;
+    std::unique_ptr<Shard[]> shards_;
+    Hash                     hash_;
+    Eq                       eq_;
+
+    static unsigned log2_ceil(std::size_t n) noexcept { unsigned b = 0; while((std::size_t(1) << b) < n) ++b; return b; }
+    static SharedPtr<Node> make_node(const K& k, Value v, SharedPtr<Node> next) {
+        return allocate_shared_ptr<Node>(std::allocator<Node>(), k, std::move(v), std::move(next));
+    }
+
+    // MurmurHash3 finaliser (std::hash is often the identity): the top
+    // bits pick the shard, the low bits the bucket.
+    std::uint64_t mix(const K& k) const {
+        std::uint64_t h = static_cast<std::uint64_t>(hash_(k));
+        h ^= h >> 33; h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33; h *= 0xc4ceb9fe1a85ec53ull;
+        return h ^ (h >> 33);
+    }
+    Shard& shard(std::uint64_t h) const noexcept { return shards_[shard_bits_ ? h >> (64 - shard_bits_) : 0]; }
+
+    // A copy of the chain from `head` with node `hit` replaced by `tail`.
+    static SharedPtr<Node> relink(const Node* head, const Node* hit, SharedPtr<Node> tail) {
+        std::vector<const Node*> prefix;
+        for(const Node* n = head; n!=hit; n = n->next.get()) prefix.push_back(n);
+        for(auto it = prefix.rbegin(); it!=prefix.rend(); ++it) tail = make_node((*it)->key, (*it)->value, std::move(tail));
+        return tail;
+    }
+
+    bool put(const K& k, Value v, bool assign) {
+        const std::uint64_t h = mix(k);
+        Shard& s = shard(h);
+        SharedPtr<Node> head;                       // a replaced value dies after unlocking
+        std::lock_guard<std::mutex> lock(s.writer);
+        Table* t = s.table.load(std::memory_order_relaxed);
+        AtomicSharedPtr<Node>& slot = t->slots[h & t->mask];
+        head = slot.load();
+        const Node* hit = head.get();
+        while(hit && !eq_(hit->key, k)) hit = hit->next.get();
+        if(hit) {
+            if(assign) slot.store(relink(head.get(), hit, make_node(k, std::move(v), hit->next)));
+            return false;
+        }
+        slot.store(make_node(k, std::move(v), std::move(head)));       // new keys go in front: no copying
+        if(s.size.fetch_add(1, std::memory_order_relaxed) + 1 > (t->mask + 1) * kMaxLoad) grow(s, *t);
+        return true;
+    }
+
+    // A new, empty table of n slots (writer lock held, or in the
+    // constructor).  Replaced tables stay allocated, emptied, until the map
+    // goes away, since a reader may still be looking at one; with doubling
+    // they add up to less than the current table.
+    static Table* add_table(Shard& s, std::size_t n) {
+        s.tables.emplace_back(new Table(n));
+        return s.tables.back().get();
+    }
+
+    // Doubles a shard's table; called with its writer lock held.  The old
+    // table is flagged before it is emptied, so a reader that sees a slot
+    // emptied this way also sees the flag and retries.
+    void grow(Shard& s, Table& old) {
+        const std::size_t n = (old.mask + 1) * 2;
+        std::vector<SharedPtr<Node>> chains(n);
+        for(std::size_t i = 0; i <= old.mask; ++i) {
+            SharedPtr<Node> head = old.slots[i].load();
+            for(const Node* e = head.get(); e; e = e->next.get()) {
+                SharedPtr<Node>& c = chains[mix(e->key) & (n - 1)];
+                c = make_node(e->key, e->value, std::move(c));
+            }
+        }
+        Table* t = add_table(s, n);
+        for(std::size_t i = 0; i < n; ++i) if(chains[i]) t->slots[i].store(std::move(chains[i]));
+        s.table.store(t, std::memory_order_release);
+        old.retired.store(true, std::memory_order_release);
+        for(std::size_t i = 0; i <= old.mask; ++i) old.slots[i].store(SharedPtr<Node>());
+    }
+};
+
+#endif // CONCURRENT_MAP_H
@@ -0,0 +1,52 @@
+#ifndef COW_PTR_H
+#define COW_PTR_H
+
+#include <cstddef>      // std::size_t
+#include <utility>      // std::forward, std::move
+#include "SharedPtr.h"
+
+// ============================== CowPtr ===============================
+// Copy-on-write handle over SharedPtr<T>.  Copies share the object;
+// read() is a plain dereference and write() clones (via T's copy ctor)
+// only when another CowPtr still shares it.
+//
+// The uniqueness test is SharedPtr::unique(), whose load is an acquire in
+// the SHPTR_THREADSAFE build, so writes made by former co-owners are
+// visible before we mutate in place.  A reference returned by write()
+// must not be used after this CowPtr has been copied again.
+
+template<class T>
+class CowPtr {
+public:
+    CowPtr() noexcept = default;
+    explicit CowPtr(T* p) : p_(p) {}
+    explicit CowPtr(SharedPtr<T> p) noexcept : p_(std::move(p)) {}
+
+    template<class... A>
+    static CowPtr make(A&&... args) { return CowPtr(new T(std::forward<A>(args)...)); }
+
+    //‑‑ read side: never copies, never touches the counter ‑‑//
+    const T& read()          const { assert(p_); return *p_; }
+    const T& operator*()     const { return read(); }
+    const T* operator->()    const noexcept { return p_.get(); }
+    explicit operator bool() const noexcept { return static_cast<bool>(p_); }
+
+    //‑‑ write side ‑‑//
+    T& write() {
+        assert(p_);
+        if(!p_.unique()) p_ = SharedPtr<T>(new T(*p_));
+        return *p_;
+    }
+    template<class F> void update(F&& f) { f(write()); }
+
+    std::size_t         use_count() const noexcept { return p_.use_count(); }
+    const SharedPtr<T>& shared()    const noexcept { return p_; }
+    void swap(CowPtr& o) noexcept { p_.swap(o.p_); }
+
+private:
+    SharedPtr<T> p_;
+};
+
+template<class T> inline void swap(CowPtr<T>& a, CowPtr<T>& b) noexcept { a.swap(b); }
+
+#endif // COW_PTR_H
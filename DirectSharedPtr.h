@@ -0,0 +1,98 @@
+#ifndef DIRECT_SHARED_PTR_H
+#define DIRECT_SHARED_PTR_H
+
+#include <cstddef>      // std::nullptr_t, std::size_t
+#include <utility>      // std::swap
+#include "SharedPtr.h"
+
+// ========================== DirectSharedPtr ==========================
+// Two-word handle: the object pointer sits next to the control-block
+// pointer, so get(), operator-> and operator[] are one load instead of
+// SharedPtr's load through cb_->ptr.  The price is a 16-byte handle and
+// two words to copy.  It shares the control-block format with SharedPtr,
+// so converting either way only bumps the counter; blocks from pools,
+// factories and allocate_shared_ptr() work unchanged.
+
+template<class T>
+class DirectSharedPtr {
+public:
+    //‑‑ ctors ‑‑//
+    constexpr DirectSharedPtr() noexcept : ptr_(nullptr), cb_(nullptr) {}
+    constexpr DirectSharedPtr(std::nullptr_t) noexcept : ptr_(nullptr), cb_(nullptr) {}
+    explicit DirectSharedPtr(T* p) : ptr_(p), cb_(p ? detail::new_block(p, false) : nullptr) {}
+    DirectSharedPtr(const SharedPtr<T>& s) noexcept : ptr_(s.get()), cb_(detail::SharedPtrAccess::block(s)) { inc(); }
+
+    DirectSharedPtr(const DirectSharedPtr& o) noexcept : ptr_(o.ptr_), cb_(o.cb_) { inc(); }
+    DirectSharedPtr(DirectSharedPtr&& o) noexcept : ptr_(o.ptr_), cb_(o.cb_) { o.ptr_=nullptr; o.cb_=nullptr; }
+    ~DirectSharedPtr() { dec(); }
+
+    DirectSharedPtr& operator=(const DirectSharedPtr& r) noexcept { DirectSharedPtr(r).swap(*this); return *this; }
+    DirectSharedPtr& operator=(DirectSharedPtr&& r) noexcept { DirectSharedPtr(std::move(r)).swap(*this); return *this; }
+
+    //‑‑ observers ‑‑//
+    T* get()                 const noexcept { return ptr_; }
+    std::size_t use_count()  const noexcept { return detail::count_of(cb_); }
+    bool unique()            const noexcept { return use_count()==1; }
+    explicit operator bool() const noexcept { return ptr_!=nullptr; }
+    T&  operator*()          const { assert(ptr_); return *ptr_; }
+    T*  operator->()         const noexcept { return ptr_; }
+
+    // back to the one-word layout, sharing the same block
+    SharedPtr<T> shared() const noexcept { inc(); return detail::SharedPtrAccess::adopt<SharedPtr<T>>(cb_); }
+
+    //‑‑ modifiers ‑‑//
+    void reset() noexcept { dec(); ptr_=nullptr; cb_=nullptr; }
+    void reset(T* p)      { if(ptr_!=p) DirectSharedPtr(p).swap(*this); }
+    void swap(DirectSharedPtr& o) noexcept { std::swap(ptr_, o.ptr_); std::swap(cb_, o.cb_); }
+
+private:
+    T*                        ptr_;
+    detail::ControlBlock<T*>* cb_;
+
+    static void delete_object(T* p){ delete p; }
+    void inc() const noexcept { if(cb_) detail::retain(cb_); }
+    void dec() noexcept { if(cb_) detail::release(cb_, delete_object); }
+};
+
+template<class T>
+class DirectSharedPtr<T[]> {
+public:
+    constexpr DirectSharedPtr() noexcept : ptr_(nullptr), cb_(nullptr) {}
+    constexpr DirectSharedPtr(std::nullptr_t) noexcept : ptr_(nullptr), cb_(nullptr) {}
+    explicit DirectSharedPtr(T* p) : ptr_(p), cb_(p ? detail::new_block(p, true) : nullptr) {}
+    DirectSharedPtr(const SharedPtr<T[]>& s) noexcept : ptr_(s.get()), cb_(detail::SharedPtrAccess::block(s)) { inc(); }
+
+    DirectSharedPtr(const DirectSharedPtr& o) noexcept : ptr_(o.ptr_), cb_(o.cb_) { inc(); }
+    DirectSharedPtr(DirectSharedPtr&& o) noexcept : ptr_(o.ptr_), cb_(o.cb_) { o.ptr_=nullptr; o.cb_=nullptr; }
+    ~DirectSharedPtr() { dec(); }
+
+    DirectSharedPtr& operator=(const DirectSharedPtr& r) noexcept { DirectSharedPtr(r).swap(*this); return *this; }
+    DirectSharedPtr& operator=(DirectSharedPtr&& r) noexcept { DirectSharedPtr(std::move(r)).swap(*this); return *this; }
+
+    // observers
+    T* get()                 const noexcept { return ptr_; }
+    std::size_t use_count()  const noexcept { return detail::count_of(cb_); }
+    bool unique()            const noexcept { return use_count()==1; }
+    explicit operator bool() const noexcept { return ptr_!=nullptr; }
+    T& operator[](std::size_t i) const { assert(ptr_); return ptr_[i]; }
+
+    SharedPtr<T[]> shared() const noexcept { inc(); return detail::SharedPtrAccess::adopt<SharedPtr<T[]>>(cb_); }
+
+    // modifiers
+    void reset() noexcept { dec(); ptr_=nullptr; cb_=nullptr; }
+    void reset(T* p)      { if(ptr_!=p) DirectSharedPtr(p).swap(*this); }
+    void swap(DirectSharedPtr& o) noexcept { std::swap(ptr_, o.ptr_); std::swap(cb_, o.cb_); }
+
+private:
+    T*                        ptr_;
+    detail::ControlBlock<T*>* cb_;
+
+    static void delete_array(T* p){ delete[] p; }
+    void inc() const noexcept { if(cb_) detail::retain(cb_); }
+    void dec() noexcept { if(cb_) detail::release(cb_, delete_array); }
+};
+
+template<class T> inline void swap(DirectSharedPtr<T>& a, DirectSharedPtr<T>& b) noexcept { a.swap(b); }
+template<class T> inline void swap(DirectSharedPtr<T[]>& a, DirectSharedPtr<T[]>& b) noexcept { a.swap(b); }
+
+#endif // DIRECT_SHARED_PTR_H
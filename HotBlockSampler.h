@@ -0,0 +1,197 @@
+#ifndef HOT_BLOCK_SAMPLER_H
+#define HOT_BLOCK_SAMPLER_H
+
+#include <algorithm>            // std::nth_element, std::sort, std::find
+#include <iterator>             // std::next
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>              // std::uint64_t
+#include <cstdio>               // std::FILE, std::fprintf
+#include <ctime>                // std::time, std::strftime, localtime_r
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>          // std::remove_pointer
+#include <unordered_map>
+#include <vector>
+#include "SharedPtr.h"
+#include "TypeName.h"
+
+// ========================= Hot control blocks ========================
+// With -DSHPTR_SAMPLE_CB every thread samples about 1 in N counter
+// updates (inc and dec) and records the control block's address, the
+// pointee type and the sampling thread.  hot_block_report() ranks the
+// blocks by samples and tells how many distinct threads touched each
+// one; HotBlockReporter prints the top K every interval, e.g. to stderr
+// or a log attached to an incident.
+//
+// The skip counter is thread-local and randomised around N, so strictly
+// alternating copy/release loops do not alias with the period.  Sampled
+// updates take a mutex, so the period should keep them rare (default
+// SHPTR_SAMPLE_PERIOD = 1024).  A freed block's address may come back for
+// another object: an entry whose type changes starts over, one whose type
+// stays the same carries on.  The table keeps at most 4096 blocks and
+// drops the colder half when full.
+
+#ifndef SHPTR_SAMPLE_PERIOD
+  #define SHPTR_SAMPLE_PERIOD 1024
+#endif
+
+struct HotBlock {
+    const void*   block;
+    std::string   type;
+    std::uint64_t inc_samples, dec_samples;
+    std::size_t   threads;          // distinct sampling threads, capped at kMaxFanIn
+    std::size_t   last_count;       // use_count() at the latest sample
+};
+
+namespace detail {
+    constexpr std::size_t kMaxFanIn     = 64;
+    constexpr std::size_t kMaxHotBlocks = 4096;
+
+    struct SampledBlock {
+        std::string (*type)();
+        std::uint64_t incs = 0, decs = 0;
+        std::size_t   last_count = 0;
+        std::vector<unsigned> threads;
+    };
+    struct SamplerTable {
+        std::mutex                                     mutex;
+        std::unordered_map<const void*, SampledBlock> blocks;
+        std::atomic<unsigned>                          period{SHPTR_SAMPLE_PERIOD};
+        std::atomic<unsigned>                          next_thread{1};
+    };
+    // Leaked on purpose: counters still change during static destruction.
+    inline SamplerTable& sampler_table() { static SamplerTable* t = new SamplerTable; return *t; }
+
+    // trivially destructible, so usable while the thread is exiting
+    inline thread_local unsigned      sample_skip   = 0;
+    inline thread_local unsigned      sampler_id    = 0;
+    inline thread_local std::uint32_t sampler_state = 0;
+
+    inline unsigned next_sample_skip() noexcept {
+        if(!sampler_state) sampler_state = 0x9e3779b9u ^ static_cast<std::uint32_t>(reinterpret_cast<std::uintptr_t>(&sampler_state));
+        sampler_state ^= sampler_state << 13; sampler_state ^= sampler_state >> 17; sampler_state ^= sampler_state << 5;
+        const unsigned n = sampler_table().period.load(std::memory_order_relaxed);
+        return n <= 1 ? 1 : 1 + sampler_state % (2 * n - 1);       // mean n
+    }
+
+    inline void evict_cold_blocks(std::unordered_map<const void*, SampledBlock>& blocks) {
+        std::vector<std::uint64_t> heat;
+        heat.reserve(blocks.size());
+        for(const auto& b : blocks) heat.push_back(b.second.incs + b.second.decs);
+        std::nth_element(heat.begin(), heat.begin() + heat.size() / 2, heat.end());
+        const std::uint64_t median = heat[heat.size() / 2];
+        for(auto it = blocks.begin(); it!=blocks.end(); )
+            it = it->second.incs + it->second.decs <= median ? blocks.erase(it) : std::next(it);
+    }
+
+    inline void record_sample(const void* cb, std::string (*type)(), bool increment, std::size_t count) noexcept {
+        if(!sampler_id) sampler_id = sampler_table().next_thread.fetch_add(1, std::memory_order_relaxed);
+        SamplerTable& t = sampler_table();
+        try {
+            std::lock_guard<std::mutex> lock(t.mutex);
+            if(t.blocks.size() >= kMaxHotBlocks && !t.blocks.count(cb)) evict_cold_blocks(t.blocks);
+            SampledBlock& b = t.blocks[cb];
+            if(b.type!=type) { b = SampledBlock(); b.type = type; }   // new entry or reused address
+            ++(increment ? b.incs : b.decs);
+            b.last_count = count;
+            if(b.threads.size() < kMaxFanIn && std::find(b.threads.begin(), b.threads.end(), sampler_id)==b.threads.end())
+                b.threads.push_back(sampler_id);
+        } catch(...) {}                                              // out of memory: drop the sample
+    }
+
+    template<class P>
+    void sample_block(const ControlBlock<P>* cb, bool increment) noexcept {
+        if(sample_skip > 1) { --sample_skip; return; }
+        sample_skip = next_sample_skip();
+        record_sample(cb, &type_name<typename std::remove_pointer<P>::type>, increment, count_of(cb));
+    }
+
+    // std::localtime shares one static buffer; reports run on their own thread
+    inline std::tm local_time(std::time_t t) noexcept {
+        std::tm tm{};
+#ifdef _WIN32
+        localtime_s(&tm, &t);
+#else
+        localtime_r(&t, &tm);
+#endif
+        return tm;
+    }
+}
+
+// Average number of counter updates per sample (per thread).
+inline void     set_hot_block_sample_period(unsigned n) noexcept { detail::sampler_table().period.store(n ? n : 1, std::memory_order_relaxed); }
+inline unsigned hot_block_sample_period() noexcept { return detail::sampler_table().period.load(std::memory_order_relaxed); }
+
+// The k most-sampled blocks, hottest first.
+inline std::vector<HotBlock> hot_block_report(std::size_t k = 10) {
+    std::vector<HotBlock> out;
+    {
+        detail::SamplerTable& t = detail::sampler_table();
+        std::lock_guard<std::mutex> lock(t.mutex);
+        out.reserve(t.blocks.size());
+        for(const auto& b : t.blocks)
+            out.push_back({b.first, std::string(), b.second.incs, b.second.decs, b.second.threads.size(), b.second.last_count});
+        auto hotter = [](const HotBlock& a, const HotBlock& b) { return a.inc_samples + a.dec_samples > b.inc_samples + b.dec_samples; };
+        if(out.size() > k) { std::nth_element(out.begin(), out.begin() + k, out.end(), hotter); out.resize(k); }
+        std::sort(out.begin(), out.end(), hotter);
+        for(HotBlock& h : out) h.type = t.blocks[h.block].type();
+    }
+    return out;
+}
+
+inline void hot_block_reset() {
+    detail::SamplerTable& t = detail::sampler_table();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    t.blocks.clear();
+}
+
+// Prints the top k with estimated update counts (samples × period).
+inline void print_hot_blocks(std::FILE* out = stderr, std::size_t k = 10) {
+    char when[32];
+    const std::tm now = detail::local_time(std::time(nullptr));
+    std::strftime(when, sizeof when, "%Y-%m-%d %H:%M:%S", &now);
+    const double period = hot_block_sample_period();
+    std::fprintf(out, "hot control blocks at %s (1 in ~%.0f updates sampled)\n", when, period);
+    std::fprintf(out, "%-18s %-28s %12s %12s %8s %8s\n", "block", "type", "~incs", "~decs", "threads", "count");
+    for(const HotBlock& h : hot_block_report(k))
+        std::fprintf(out, "%-18p %-28s %12.0f %12.0f %7zu%s %8zu\n", h.block, h.type.c_str(),
+                     static_cast<double>(h.inc_samples) * period, static_cast<double>(h.dec_samples) * period,
+                     h.threads, h.threads >= detail::kMaxFanIn ? "+" : " ", h.last_count);
+    std::fflush(out);
+}
+
+// Background thread printing the top k every `interval`; with `reset`
+// each report covers only the last interval.
+class HotBlockReporter {
+public:
+    explicit HotBlockReporter(std::chrono::milliseconds interval, std::size_t k = 10, std::FILE* out = stderr, bool reset = true)
+        : thread_([this, interval, k, out, reset] { run(interval, k, out, reset); }) {}
+    ~HotBlockReporter() {
+        { std::lock_guard<std::mutex> lock(mutex_); stop_ = true; }
+        wake_.notify_one();
+        thread_.join();
+    }
+    HotBlockReporter(const HotBlockReporter&) = delete;
+    HotBlockReporter& operator=(const HotBlockReporter&) = delete;
+
+private:
+    std::mutex              mutex_;
+    std::condition_variable wake_;
+    bool                    stop_ = false;
+    std::thread             thread_;      // last: starts after the members above exist
+
+    void run(std::chrono::milliseconds interval, std::size_t k, std::FILE* out, bool reset) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while(!wake_.wait_for(lock, interval, [this] { return stop_; })) {
+            lock.unlock();
+            print_hot_blocks(out, k);
+            if(reset) hot_block_reset();
+            lock.lock();
+        }
+    }
+};
+
+#endif // HOT_BLOCK_SAMPLER_H
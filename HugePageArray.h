@@ -0,0 +1,61 @@
+#ifndef HUGE_PAGE_ARRAY_H
+#define HUGE_PAGE_ARRAY_H
+
+#include <cstddef>      // std::size_t
+#include <cstdint>      // std::uintptr_t
+#include <new>          // std::bad_alloc
+#include <type_traits>
+#include "MappedArray.h"
+
+// ====================== make_huge_array<T> (POSIX) ===================
+// Anonymous mapping for big SharedPtr<T[]> arrays, aligned to 2 MB and
+// madvise(MADV_HUGEPAGE)d so transparent huge pages can back it: far
+// fewer TLB misses on random access.  The block is a detail::MappingBlock,
+// so the last release munmaps exactly the aligned range and
+// mapped_length()/mapped_span() work as for map_file().
+//
+// Fallbacks: without MADV_HUGEPAGE (or if the kernel refuses it) the
+// mapping still works with normal pages; if mmap itself fails the array
+// comes from make_shared_array<T>(n).  huge_page_advised() tells which case you got.
+// Elements start zeroed; T must be trivially copyable.
+
+constexpr std::size_t kHugePageSize = std::size_t(2) << 20;
+
+template<class T>
+SharedPtr<T[]> make_huge_array(std::size_t n, bool prefault = true) {
+    static_assert(std::is_trivially_copyable<T>::value, "make_huge_array<T>: T must be trivially copyable");
+    if(n==0) return SharedPtr<T[]>();
+
+    const std::size_t bytes = (n * sizeof(T) + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+    // over-reserve by one huge page, then trim to a 2 MB-aligned window
+    void* raw = ::mmap(nullptr, bytes + kHugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(raw==MAP_FAILED) return make_shared_array<T>(n);
+
+    auto  addr    = reinterpret_cast<std::uintptr_t>(raw);
+    auto  aligned = (addr + kHugePageSize - 1) & ~(std::uintptr_t(kHugePageSize) - 1);
+    char* base    = reinterpret_cast<char*>(aligned);
+    if(aligned!=addr) ::munmap(raw, aligned - addr);
+    ::munmap(base + bytes, kHugePageSize - (aligned - addr));
+
+    bool advised = false;
+#ifdef MADV_HUGEPAGE
+    advised = ::madvise(base, bytes, MADV_HUGEPAGE)==0;
+#endif
+    if(prefault)   // first touch after madvise faults in whole huge pages
+        for(std::size_t off = 0; off < bytes; off += advised ? kHugePageSize : 4096) base[off] = 0;
+
+    using Block = detail::MappingBlock<T>;
+    Block* b;
+    try { b = new Block(base, bytes, n); } catch(...) { ::munmap(base, bytes); throw; }
+    b->huge_pages = advised;
+    return detail::SharedPtrAccess::adopt<SharedPtr<T[]>>(detail::accounted<T>(b, true, n));
+}
+
+// True if `a` came from make_huge_array() and the kernel accepted MADV_HUGEPAGE.
+template<class T>
+bool huge_page_advised(const SharedPtr<T[]>& a) noexcept {
+    const auto* m = detail::mapping_of(a);
+    return m && m->huge_pages;
+}
+
+#endif // HUGE_PAGE_ARRAY_H
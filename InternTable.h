@@ -0,0 +1,164 @@
+#ifndef INTERN_TABLE_H
+#define INTERN_TABLE_H
+
+#include <atomic>
+#include <cstddef>      // std::size_t
+#include <cstdint>      // std::uint64_t
+#include <functional>   // std::hash, std::equal_to
+#include <memory>       // std::unique_ptr
+#include <mutex>
+#include <new>          // placement new
+#include <shared_mutex>
+#include <type_traits>  // std::decay_t
+#include <unordered_map>
+#include <utility>      // std::forward
+#include "SharedPtr.h"
+
+// ============================ InternTable ============================
+// Flyweight table: intern(v) returns a SharedPtr<const T> to the one
+// live object equal to v, creating it on first use.  Many equal strings
+// or configs then share one allocation.
+//
+// The table only lists its objects and holds no reference, so an entry
+// goes away with its last handle.  The block's dispose hook unlists it
+// before the object is destroyed.  Between that final release and the
+// unlisting, a lookup still finds the block, but its count is zero.
+// try_retain() refuses to revive it, and intern() then makes a fresh
+// object.
+//
+// Keys are spread over shards with a std::shared_mutex each; a hit takes
+// only the shared lock.  Handles may outlive the table.  Threads may
+// share a table only with -DSHPTR_THREADSAFE.
+
+namespace detail {
+    template<class T, class Hash, class Eq> struct InternState;
+
+    template<class T, class Hash, class Eq>
+    struct InternBlock : HookedBlock<const T*> {
+        InternState<T, Hash, Eq>* state;
+        std::size_t               hash;
+        alignas(T) unsigned char  storage[sizeof(T)];
+
+        InternBlock(InternState<T, Hash, Eq>* s, std::size_t h) noexcept
+            : HookedBlock<const T*>(reinterpret_cast<const T*>(storage), &dispose), state(s), hash(h) {}
+        static void dispose(ControlBlock<const T*>* cb) noexcept {
+            auto* b = static_cast<InternBlock*>(cb);
+            InternState<T, Hash, Eq>* s = b->state;
+            s->unlist(b);
+            cb->ptr->~T();
+            delete b;
+            s->unref();
+        }
+    };
+
+    template<class T, class Hash, class Eq>
+    struct InternState {
+        using Block = InternBlock<T, Hash, Eq>;
+        struct alignas(64) Shard {
+            mutable std::shared_mutex                        mutex;
+            std::unordered_multimap<std::size_t, Block*>     blocks;     // by hash, not owned
+        };
+
+        std::atomic<std::size_t> refs{1};           // the table + every live object
+        const unsigned           shard_bits;
+        std::unique_ptr<Shard[]> shards;
+        Hash                     hash;
+        Eq                       eq;
+
+        InternState(unsigned bits, Hash h, Eq e)
+            : shard_bits(bits), shards(new Shard[std::size_t(1) << bits]), hash(std::move(h)), eq(std::move(e)) {}
+
+        Shard& shard(std::size_t h) noexcept {
+            const std::uint64_t m = static_cast<std::uint64_t>(h) * 0x9e3779b97f4a7c15ull;
+            return shards[shard_bits ? m >> (64 - shard_bits) : 0];
+        }
+        void unlist(Block* b) noexcept {
+            Shard& s = shard(b->hash);
+            std::lock_guard<std::shared_mutex> lock(s.mutex);
+            auto range = s.blocks.equal_range(b->hash);
+            for(auto it = range.first; it!=range.second; ++it)
+                if(it->second==b) { s.blocks.erase(it); return; }
+        }
+        void unref() noexcept { if(refs.fetch_sub(1, std::memory_order_acq_rel)==1) delete this; }
+    };
+}
+
+template<class T, class Hash = std::hash<T>, class Eq = std::equal_to<T>>
+class InternTable {
+    using State = detail::InternState<T, Hash, Eq>;
+    using Block = typename State::Block;
+    using Shard = typename State::Shard;
+public:
+    using Handle = SharedPtr<const T>;
+
+    // `shards` is rounded up to a power of two.
+    explicit InternTable(std::size_t shards = 16, Hash hash = Hash(), Eq eq = Eq())
+        : st_(new State(log2_ceil(shards), std::move(hash), std::move(eq))) {}
+    ~InternTable() { st_->unref(); }
+    InternTable(const InternTable&) = delete;
+    InternTable& operator=(const InternTable&) = delete;
+
+    // The shared object equal to v; copies or moves v in on first use.
+    template<class U>
+    Handle intern(U&& v) {
+        const std::size_t h = st_->hash(v);
+        Shard& s = st_->shard(h);
+        {
+            std::shared_lock<std::shared_mutex> lock(s.mutex);
+            if(Block* b = find(s, h, v)) return adopt(b);
+        }
+        // Built outside the lock: T's constructor and destructor may touch
+        // this table themselves.
+        std::unique_ptr<Block> b(new Block(st_, h));
+        ::new (static_cast<void*>(b->storage)) T(std::forward<U>(v));
+        Block* hit = nullptr;
+        try {
+            std::lock_guard<std::shared_mutex> lock(s.mutex);
+            hit = find(s, h, *b->ptr);                          // another thread may have won
+            if(!hit) s.blocks.emplace(h, b.get());
+        } catch(...) { b->ptr->~T(); throw; }
+        if(hit) { b->ptr->~T(); return adopt(hit); }
+        st_->refs.fetch_add(1, std::memory_order_relaxed);
+        return detail::SharedPtrAccess::adopt<Handle>(detail::accounted<T>(b.release(), false, 0, sizeof(Block) - sizeof(T)));
+    }
+
+    // The shared object equal to v if one is alive; null otherwise.
+    Handle find(const T& v) const {
+        const std::size_t h = st_->hash(v);
+        Shard& s = st_->shard(h);
+        std::shared_lock<std::shared_mutex> lock(s.mutex);
+        Block* b = find(s, h, v);
+        return b ? adopt(b) : Handle();
+    }
+
+    // Distinct live objects (approximate under concurrency).
+    std::size_t size() const {
+        std::size_t n = 0;
+        for(std::size_t i = 0; i < shard_count(); ++i) {
+            std::shared_lock<std::shared_mutex> lock(st_->shards[i].mutex);
+            n += st_->shards[i].blocks.size();
+        }
+        return n;
+    }
+    std::size_t shard_count() const noexcept { return std::size_t(1) << st_->shard_bits; }
+
+private:
+    State* st_;
+
+    static unsigned log2_ceil(std::size_t n) noexcept { unsigned b = 0; while((std::size_t(1) << b) < n) ++b; return b; }
+    static Handle adopt(Block* b) noexcept { return detail::SharedPtrAccess::adopt<Handle>(static_cast<detail::ControlBlock<const T*>*>(b)); }
+
+    // A listed block equal to v that is still alive, with a reference
+    // taken for the caller (either lock held).
+    template<class U>
+    Block* find(Shard& s, std::size_t h, const U& v) const {
+        auto range = s.blocks.equal_range(h);
+        for(auto it = range.first; it!=range.second; ++it) {
+            Block* b = it->second;
+            if(st_->eq(*b->ptr, v) && detail::try_retain(static_cast<detail::ControlBlock<const T*>*>(b))) return b;
+        }
+        return nullptr;
+    }
+};
+
+#endif // INTERN_TABLE_H
@@ -0,0 +1,69 @@
+#ifndef LOCK_FREE_QUEUE_H
+#define LOCK_FREE_QUEUE_H
+
+#include <memory>       // std::allocator
+#include <utility>      // std::move
+#include "AtomicSharedPtr.h"
+
+// =========================== LockFreeQueue ===========================
+// Unbounded Michael–Scott MPMC queue on AtomicSharedPtr.  The head is a
+// dummy node, and the first real element sits in head->next.  A lagging
+// tail is helped forward by whichever thread sees it.  Holding a
+// SharedPtr to a node keeps it alive, so a dequeuer can read the value
+// after its CAS, and node addresses cannot recur while a CAS that
+// expects them is pending.  Unlike SharedQueue it has no capacity limit,
+// but every push allocates a node and each load costs three RMWs.
+
+template<class T>
+class LockFreeQueue {
+    struct Node {
+        T                     value{};
+        AtomicSharedPtr<Node> next;
+        Node() = default;
+        explicit Node(T v) : value(std::move(v)) {}
+    };
+    static SharedPtr<Node> node() { return allocate_shared_ptr<Node>(std::allocator<Node>()); }
+    static SharedPtr<Node> node(T v) { return allocate_shared_ptr<Node>(std::allocator<Node>(), std::move(v)); }
+
+public:
+    LockFreeQueue() { SharedPtr<Node> d = node(); head_.store(d); tail_.store(std::move(d)); }
+    LockFreeQueue(const LockFreeQueue&) = delete;
+    LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+
+    void push(T value) {
+        SharedPtr<Node> n = node(std::move(value));
+        for(;;) {
+            SharedPtr<Node> t = tail_.load();
+            SharedPtr<Node> next = t->next.load();
+            if(!next) {
+                if(t->next.compare_exchange_strong(next, n)) { tail_.compare_exchange_strong(t, n); return; }
+            }
+            else tail_.compare_exchange_strong(t, next);        // help a lagging tail
+        }
+    }
+
+    // Moves the oldest element into `out`; false if the queue was empty.
+    bool try_pop(T& out) {
+        for(;;) {
+            SharedPtr<Node> h = head_.load();
+            SharedPtr<Node> next = h->next.load();
+            if(!next) return false;
+            SharedPtr<Node> t = tail_.load();
+            if(h.get()==t.get()) { tail_.compare_exchange_strong(t, next); continue; }
+            if(head_.compare_exchange_strong(h, next)) {
+                out = std::move(next->value);   // next is the new dummy; only we read its value
+                next->value = T();
+                return true;
+            }
+        }
+    }
+
+    // approximate under concurrency
+    bool empty() const noexcept { return !head_.load()->next.load(); }
+
+private:
+    AtomicSharedPtr<Node> head_;
+    AtomicSharedPtr<Node> tail_;
+};
+
+#endif // LOCK_FREE_QUEUE_H
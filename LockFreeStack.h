@@ -0,0 +1,49 @@
+#ifndef LOCK_FREE_STACK_H
+#define LOCK_FREE_STACK_H
+
+#include <utility>      // std::move
+#include "AtomicSharedPtr.h"
+
+// =========================== LockFreeStack ===========================
+// Treiber stack whose nodes are reclaimed by reference counting: a
+// thread that loaded the head owns a reference to it, so the node cannot
+// be freed (or its address reused, the classic ABA) while the thread's
+// CAS is still pending.  No hazard pointers or epochs.  Unbounded; every
+// push allocates one node (object and block together).
+
+template<class T>
+class LockFreeStack {
+    struct Node {
+        T                  value;
+        SharedPtr<Node>    next;
+        explicit Node(T v) : value(std::move(v)) {}
+    };
+
+public:
+    LockFreeStack() = default;
+    LockFreeStack(const LockFreeStack&) = delete;
+    LockFreeStack& operator=(const LockFreeStack&) = delete;
+
+    void push(T value) {
+        SharedPtr<Node> n = allocate_shared_ptr<Node>(std::allocator<Node>(), std::move(value));
+        n->next = head_.load();
+        while(!head_.compare_exchange_weak(n->next, n)) {}
+    }
+
+    // Moves the top element into `out`; false if the stack was empty.
+    bool try_pop(T& out) {
+        SharedPtr<Node> h = head_.load();
+        while(h && !head_.compare_exchange_weak(h, h->next)) {}
+        if(!h) return false;
+        out = std::move(h->value);      // only the winning thread touches value
+        return true;
+    }
+
+    // approximate under concurrency
+    bool empty() const noexcept { return !head_.load(); }
+
+private:
+    AtomicSharedPtr<Node> head_;
+};
+
+#endif // LOCK_FREE_STACK_H
@@ -0,0 +1,203 @@
+#ifndef LRU_CACHE_H
+#define LRU_CACHE_H
+
+#include <atomic>
+#include <cstddef>      // std::size_t
+#include <cstdint>      // std::uint64_t
+#include <functional>   // std::hash, std::equal_to
+#include <memory>       // std::unique_ptr
+#include <mutex>
+#include <shared_mutex>
+#include <tuple>        // std::forward_as_tuple
+#include <unordered_map>
+#include <utility>      // std::move, std::piecewise_construct
+#include <vector>
+#include "SharedPtr.h"
+
+// ============================== LruCache =============================
+// Bounded cache of SharedPtr<V>.  Evicting an entry only drops the
+// cache's reference: handles already returned by find() stay valid, and
+// the value is destroyed by whoever releases it last, never under the
+// cache's lock.
+//
+// Keys are spread over shards, each with its own byte budget (max_bytes
+// / shards) and a std::shared_mutex.  Recency is approximated with CLOCK:
+// a hit only sets the entry's reference bit under the shared lock, so
+// concurrent hits neither serialise nor reorder a list.  When an insert
+// goes over budget, the shard's hand sweeps its ring.  It clears set bits
+// and evicts the first entry whose bit is already clear.  Each entry is
+// charged the byte count given to insert().
+//
+// Threads may share a cache only with -DSHPTR_THREADSAFE (hits copy the
+// SharedPtr under a shared lock).
+
+struct LruCacheStats {
+    std::uint64_t hits = 0, misses = 0, insertions = 0, evictions = 0;
+    double hit_rate() const noexcept { return hits + misses ? double(hits) / double(hits + misses) : 0.0; }
+};
+
+template<class K, class V, class Hash = std::hash<K>, class Eq = std::equal_to<K>>
+class LruCache {
+public:
+    using Value = SharedPtr<V>;
+
+private:
+    struct Entry {
+        Value                     value;
+        std::size_t               charge;
+        std::size_t               slot;             // position in the shard's ring
+        mutable std::atomic<bool> referenced{false};
+        Entry(Value v, std::size_t c, std::size_t s) : value(std::move(v)), charge(c), slot(s) {}
+    };
+    using Index = std::unordered_map<K, Entry, Hash, Eq>;
+    using Item  = typename Index::value_type;       // node addresses are stable
+
+    struct alignas(64) Shard {
+        mutable std::shared_mutex  mutex;
+        Index                      index;
+        std::vector<Item*>         ring;            // CLOCK order
+        std::size_t                hand  = 0;
+        std::size_t                bytes = 0;
+        mutable std::atomic<std::uint64_t> hits{0}, misses{0};
+        std::uint64_t              insertions = 0, evictions = 0;    // under the exclusive lock
+    };
+
+public:
+    // `shards` is rounded up to a power of two.
+    explicit LruCache(std::size_t max_bytes, std::size_t shards = 16, Hash hash = Hash(), Eq eq = Eq())
+        : shard_bits_(log2_ceil(shards)), shards_(new Shard[std::size_t(1) << shard_bits_]),
+          budget_(max_bytes >> shard_bits_) {
+        for(std::size_t i = 0; i < shard_count(); ++i) shards_[i].index = Index(0, hash, eq);
+    }
+    LruCache(const LruCache&) = delete;
+    LruCache& operator=(const LruCache&) = delete;
+
+    // The cached value, or null.  A hit marks the entry recently used.
+    Value find(const K& k) const {
+        const Shard& s = shard(k);
+        std::shared_lock<std::shared_mutex> lock(s.mutex);
+        auto it = s.index.find(k);
+        if(it==s.index.end()) { s.misses.fetch_add(1, std::memory_order_relaxed); return Value(); }
+        const Entry& e = it->second;
+        if(!e.referenced.load(std::memory_order_relaxed)) e.referenced.store(true, std::memory_order_relaxed);
+        s.hits.fetch_add(1, std::memory_order_relaxed);
+        return e.value;
+    }
+
+    // Caches k -> v at `charge` bytes, replacing any previous value, and
+    // evicts until the shard is back within budget.  A value larger than
+    // the whole shard budget is not cached (and k is dropped); false then.
+    bool insert(const K& k, Value v, std::size_t charge = sizeof(V)) {
+        Shard& s = shard(k);
+        std::vector<Value> dropped;                 // released after unlocking
+        {
+            std::lock_guard<std::shared_mutex> lock(s.mutex);
+            auto it = s.index.find(k);
+            if(it!=s.index.end()) {
+                dropped.push_back(std::move(it->second.value));
+                unlink(s, &*it);
+            }
+            if(charge > budget_) return false;
+            while(s.bytes + charge > budget_) dropped.push_back(evict_one(s));
+            it = s.index.emplace(std::piecewise_construct, std::forward_as_tuple(k),
+                                 std::forward_as_tuple(std::move(v), charge, s.ring.size())).first;
+            s.ring.push_back(&*it);
+            s.bytes += charge;
+            ++s.insertions;
+        }
+        return true;
+    }
+
+    // Drops k and returns its value (null if absent).
+    Value erase(const K& k) {
+        Shard& s = shard(k);
+        std::lock_guard<std::shared_mutex> lock(s.mutex);
+        auto it = s.index.find(k);
+        if(it==s.index.end()) return Value();
+        Value out = std::move(it->second.value);
+        unlink(s, &*it);
+        return out;
+    }
+
+    void clear() {
+        for(std::size_t i = 0; i < shard_count(); ++i) {
+            Index old;
+            {
+                Shard& s = shards_[i];
+                std::lock_guard<std::shared_mutex> lock(s.mutex);
+                old.swap(s.index);
+                s.ring.clear(); s.hand = 0; s.bytes = 0;
+            }
+        }                                           // values released outside the locks
+    }
+
+    std::size_t size() const {
+        std::size_t n = 0;
+        for(std::size_t i = 0; i < shard_count(); ++i) { std::shared_lock<std::shared_mutex> l(shards_[i].mutex); n += shards_[i].index.size(); }
+        return n;
+    }
+    std::size_t bytes() const {
+        std::size_t n = 0;
+        for(std::size_t i = 0; i < shard_count(); ++i) { std::shared_lock<std::shared_mutex> l(shards_[i].mutex); n += shards_[i].bytes; }
+        return n;
+    }
+    std::size_t capacity() const noexcept { return budget_ << shard_bits_; }
+    std::size_t shard_count() const noexcept { return std::size_t(1) << shard_bits_; }
+
+    // Totals over all shards since construction.
+    LruCacheStats stats() const {
+        LruCacheStats out;
+        for(std::size_t i = 0; i < shard_count(); ++i) {
+            const Shard& s = shards_[i];
+            out.hits   += s.hits.load(std::memory_order_relaxed);
+            out.misses += s.misses.load(std::memory_order_relaxed);
+            std::shared_lock<std::shared_mutex> l(s.mutex);
+            out.insertions += s.insertions;
+            out.evictions  += s.evictions;
+        }
+        return out;
+    }
+
+private:
+    const unsigned           shard_bits_;
+    std::unique_ptr<Shard[]> shards_;
+    const std::size_t        budget_;               // bytes per shard
+
+    static unsigned log2_ceil(std::size_t n) noexcept { unsigned b = 0; while((std::size_t(1) << b) < n) ++b; return b; }
+
+    Shard& shard(const K& k) const {
+        // Fibonacci hashing: the top bits of the product are well mixed
+        const std::uint64_t h = static_cast<std::uint64_t>(shards_[0].index.hash_function()(k)) * 0x9e3779b97f4a7c15ull;
+        return shards_[shard_bits_ ? h >> (64 - shard_bits_) : 0];
+    }
+
+    // Removes an entry whose value has been moved out (exclusive lock
+    // held).  The ring's last entry takes its slot.
+    static void unlink(Shard& s, Item* item) {
+        const std::size_t slot = item->second.slot;
+        s.bytes -= item->second.charge;
+        s.ring[slot] = s.ring.back();
+        s.ring[slot]->second.slot = slot;
+        s.ring.pop_back();
+        if(s.hand >= s.ring.size()) s.hand = 0;
+        s.index.erase(s.index.find(item->first));  // not erase(key): that key lives in the node
+    }
+
+    // One CLOCK sweep step at a time until an unreferenced entry turns up;
+    // at most two passes over the ring.
+    static Value evict_one(Shard& s) {
+        for(;;) {
+            Item* item = s.ring[s.hand];
+            if(item->second.referenced.exchange(false, std::memory_order_relaxed)) {
+                if(++s.hand==s.ring.size()) s.hand = 0;
+                continue;
+            }
+            Value out = std::move(item->second.value);
+            unlink(s, item);
+            ++s.evictions;
+            return out;
+        }
+    }
+};
+
+#endif // LRU_CACHE_H
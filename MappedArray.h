@@ -0,0 +1,118 @@
+#ifndef MAPPED_ARRAY_H
+#define MAPPED_ARRAY_H
+
+#include <cerrno>
+#include <cstddef>        // std::size_t
+#include <stdexcept>      // std::invalid_argument
+#include <string>
+#include <system_error>   // std::system_error
+#include <type_traits>
+#include <fcntl.h>        // ::open
+#include <sys/mman.h>     // ::mmap, ::munmap, ::madvise
+#include <sys/stat.h>     // ::fstat
+#include <unistd.h>       // ::close
+#include "SharedPtr.h"
+
+// ========================== map_file<T> (POSIX) ======================
+// Maps a file of trivially-copyable T and returns a SharedPtr<T[]> whose
+// last release munmaps it.  Pages come from the page cache on demand, so
+// startup does not read the whole file and a reload does not double RSS.
+//
+//   MapMode::ReadOnly     PROT_READ, MAP_SHARED    — use a const T
+//   MapMode::CopyOnWrite  PROT_READ|WRITE, MAP_PRIVATE — writes stay private
+//
+// mapped_length() recovers the element count; mapped_span() and
+// SharedSpan::subspan() hand out zero-copy subrange handles that keep the
+// mapping alive.
+
+enum class MapMode { ReadOnly, CopyOnWrite };
+
+enum MapAdvice : unsigned {
+    AdviseNone       = 0,
+    AdviseSequential = 1u << 0,   // MADV_SEQUENTIAL
+    AdviseRandom     = 1u << 1,   // MADV_RANDOM
+    AdviseWillNeed   = 1u << 2,   // MADV_WILLNEED (start read-ahead now)
+    AdviseHugePage   = 1u << 3,   // MADV_HUGEPAGE (needs THP for the file system)
+};
+
+struct MapOptions {
+    MapMode  mode   = MapMode::ReadOnly;
+    unsigned advice = AdviseNone;
+};
+
+namespace detail {
+    // Owns one mmap(2) region; the dispose hook unmaps it.
+    template<class T>
+    struct MappingBlock : HookedBlock<T*> {
+        void*            base;
+        std::size_t      bytes;
+        std::size_t      count;
+        bool             huge_pages = false;   // MADV_HUGEPAGE accepted (make_huge_array)
+
+        MappingBlock(void* b, std::size_t n, std::size_t c) noexcept
+            : HookedBlock<T*>(static_cast<T*>(b), &dispose), base(b), bytes(n), count(c) {}
+        static void dispose(ControlBlock<T*>* cb) noexcept {
+            auto* m = static_cast<MappingBlock*>(cb);
+            ::munmap(m->base, m->bytes);
+            delete m;
+        }
+    };
+
+    inline void advise(void* p, std::size_t n, unsigned advice) noexcept {
+        // hints only: failures (e.g. no THP support) are ignored
+        if(advice & AdviseSequential) ::madvise(p, n, MADV_SEQUENTIAL);
+        if(advice & AdviseRandom)     ::madvise(p, n, MADV_RANDOM);
+        if(advice & AdviseWillNeed)   ::madvise(p, n, MADV_WILLNEED);
+#ifdef MADV_HUGEPAGE
+        if(advice & AdviseHugePage)   ::madvise(p, n, MADV_HUGEPAGE);
+#endif
+    }
+
+    template<class T>
+    const MappingBlock<T>* mapping_of(const SharedPtr<T[]>& a) noexcept {
+        auto* cb = SharedPtrAccess::block(a);
+        return dispose_of(cb)==&MappingBlock<T>::dispose ? static_cast<const MappingBlock<T>*>(cb) : nullptr;
+    }
+
+    [[noreturn]] inline void throw_errno(const char* what) { throw std::system_error(errno, std::generic_category(), what); }
+}
+
+template<class T>
+SharedPtr<T[]> map_file(const std::string& path, MapOptions opt = {}) {
+    static_assert(std::is_trivially_copyable<T>::value, "map_file<T>: T must be trivially copyable");
+    if(opt.mode==MapMode::ReadOnly && !std::is_const<T>::value)
+        throw std::invalid_argument("map_file: a read-only mapping needs a const element type");
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd<0) detail::throw_errno("map_file: open");
+    struct stat st;
+    if(::fstat(fd, &st)!=0) { int e = errno; ::close(fd); errno = e; detail::throw_errno("map_file: fstat"); }
+
+    const std::size_t bytes = static_cast<std::size_t>(st.st_size);
+    if(bytes < sizeof(T)) { ::close(fd); return SharedPtr<T[]>(); }
+
+    const bool ro = opt.mode==MapMode::ReadOnly;
+    void* p = ::mmap(nullptr, bytes, ro ? PROT_READ : PROT_READ | PROT_WRITE, ro ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+    int e = errno;
+    ::close(fd);                                    // the mapping keeps its own reference
+    if(p==MAP_FAILED) { errno = e; detail::throw_errno("map_file: mmap"); }
+    detail::advise(p, bytes, opt.advice);
+
+    using Block = detail::MappingBlock<T>;
+    Block* b;
+    try { b = new Block(p, bytes, bytes / sizeof(T)); } catch(...) { ::munmap(p, bytes); throw; }
+    return detail::SharedPtrAccess::adopt<SharedPtr<T[]>>(detail::accounted<T>(b, true, b->count));
+}
+
+// Element count of a map_file() / make_huge_array() array, 0 for anything else.
+template<class T>
+std::size_t mapped_length(const SharedPtr<T[]>& a) noexcept {
+    const auto* m = detail::mapping_of(a);
+    return m ? m->count : 0;
+}
+
+// The whole mapping as a SharedSpan; narrow it with subspan().
+template<class T>
+SharedSpan<T> mapped_span(const SharedPtr<T[]>& a) noexcept { return SharedSpan<T>(a, 0, mapped_length(a)); }
+
+#endif // MAPPED_ARRAY_H
@@ -0,0 +1,212 @@
+#ifndef MEMORY_ACCOUNTING_H
+#define MEMORY_ACCOUNTING_H
+
+#include <atomic>
+#include <cstdint>      // std::int64_t, std::uint32_t, std::uintptr_t
+#include <cstdio>       // std::FILE, std::fprintf
+#include <map>
+#include <mutex>
+#include <new>          // std::nothrow
+#include <string>
+#include <tuple>
+#include <type_traits>  // std::remove_cv
+#include <vector>
+#include "SharedPtr.h"
+#include "TypeName.h"
+
+// ========================== Memory accounting ========================
+// With -DSHPTR_ACCOUNTING every control block is charged, when it is
+// created, to a row keyed by the pointee type — and for arrays by element
+// type and length — and uncharged by its final release.  A row counts live
+// objects, their bytes, live blocks and the blocks' own overhead.
+//
+// Lengths are known for make_shared_array(), map_file() and
+// make_huge_array(); SharedPtr<T[]>(new T[n]) only sees a T*, so it lands
+// in the row with length 0 and no object bytes.  Pool nodes count while
+// handed out, not while cached.  Objects are counted at sizeof(T): heap
+// memory a T owns itself (a std::vector's buffer, say) is not seen.
+//
+// Counters live in per-thread shards written with relaxed single-writer
+// stores; a block freed on another thread than the one that made it
+// simply drives that thread's shard negative.  memory_snapshot() sums the
+// shards.  Arrays of known length look up their row under the registry
+// mutex; everything else finds it in a per-type static.  Releases during
+// thread exit, after the shard was handed back, go to a shared shard with
+// atomic adds.  At most kMaxAccountRows rows
+// exist; further array lengths of a type fold into its length-0 row.
+
+struct MemoryAccount {
+    std::string   type;             // element type for arrays
+    bool          array;
+    std::size_t   length;           // elements per array, 0 = unknown / not an array
+    std::int64_t  objects;          // live objects (arrays count once)
+    std::int64_t  object_bytes;
+    std::int64_t  blocks;           // live control blocks
+    std::int64_t  block_bytes;      // control-block overhead
+};
+
+namespace detail {
+    constexpr std::uint32_t kMaxAccountRows = 4096;
+    constexpr std::uint32_t kAccountChunk   = 64;     // rows per lazily allocated shard chunk
+
+    struct AccountRow {
+        std::string (*type)();
+        bool        array;
+        std::size_t length;
+        std::size_t object_bytes;                     // per live object
+    };
+    struct AccountCounters {
+        std::atomic<std::int64_t> objects{0}, object_bytes{0}, blocks{0}, block_bytes{0};
+    };
+    struct AccountShard {
+        std::atomic<AccountCounters*> chunks[kMaxAccountRows / kAccountChunk] = {};
+        bool in_use = false;
+    };
+    struct AccountRegistry {
+        std::mutex                   mutex;
+        AccountRow                   rows[kMaxAccountRows];
+        std::atomic<std::uint32_t>   row_count{0};
+        std::map<std::tuple<std::uintptr_t, bool, std::size_t>, std::uint32_t> index;   // (type, array, length)
+        std::vector<AccountShard*>   shards;          // never freed: reused by later threads
+        AccountShard                 orphans;         // releases after a thread's shard is gone
+    };
+    // Leaked on purpose: blocks are still released during static destruction.
+    inline AccountRegistry& account_registry() { static AccountRegistry* r = new AccountRegistry; return *r; }
+
+    constexpr std::uint32_t kNoRow = ~std::uint32_t(0);
+
+    inline std::uint32_t account_row(std::string (*type)(), std::size_t elem, bool array, std::size_t length) noexcept {
+        AccountRegistry& r = account_registry();
+        try {
+            std::lock_guard<std::mutex> lock(r.mutex);
+            const auto id = reinterpret_cast<std::uintptr_t>(type);
+            auto key = std::make_tuple(id, array, length);
+            auto it = r.index.find(key);
+            if(it!=r.index.end()) return it->second;
+            std::uint32_t n = r.row_count.load(std::memory_order_relaxed);
+            if(n==kMaxAccountRows) {
+                if(length==0) return kNoRow;
+                it = r.index.find(std::make_tuple(id, array, std::size_t(0)));
+                return it!=r.index.end() ? it->second : kNoRow;
+            }
+            r.rows[n] = {type, array, length, elem * (array ? length : 1)};
+            r.index.emplace(key, n);
+            r.row_count.store(n + 1, std::memory_order_release);
+            return n;
+        } catch(...) { return kNoRow; }
+    }
+
+    // Per-thread shard lease, as for the release histograms.
+    struct AccountLease {
+        AccountShard* shard = nullptr;
+        ~AccountLease();
+    };
+    inline thread_local bool account_retired = false;     // trivially destructible
+
+    inline AccountLease::~AccountLease() {
+        account_retired = true;
+        if(!shard) return;
+        std::lock_guard<std::mutex> lock(account_registry().mutex);
+        shard->in_use = false;
+    }
+
+    inline AccountShard* account_shard() noexcept {
+        AccountRegistry& r = account_registry();
+        if(account_retired) return &r.orphans;
+        static thread_local AccountLease lease;
+        if(!lease.shard) {
+            try {
+                std::lock_guard<std::mutex> lock(r.mutex);
+                for(AccountShard* s : r.shards) if(!s->in_use) { lease.shard = s; break; }
+                if(!lease.shard) { r.shards.push_back(new AccountShard); lease.shard = r.shards.back(); }
+                lease.shard->in_use = true;
+            } catch(...) { return &r.orphans; }
+        }
+        return lease.shard;
+    }
+
+    inline AccountCounters* account_counters(AccountShard* s, std::uint32_t row) noexcept {
+        std::atomic<AccountCounters*>& slot = s->chunks[row / kAccountChunk];
+        AccountCounters* c = slot.load(std::memory_order_acquire);
+        if(!c) {
+            AccountCounters* fresh = new (std::nothrow) AccountCounters[kAccountChunk];
+            if(!fresh) return nullptr;
+            // the orphan shard has several writers: first one wins
+            if(slot.compare_exchange_strong(c, fresh, std::memory_order_acq_rel)) c = fresh;
+            else delete[] fresh;
+        }
+        return c + row % kAccountChunk;
+    }
+
+    inline void account_add(const AccountTag& tag, std::int64_t sign) noexcept {
+        AccountShard* s = account_shard();
+        AccountCounters* c = account_counters(s, tag.row);
+        if(!c) return;
+        const std::int64_t obj = static_cast<std::int64_t>(account_registry().rows[tag.row].object_bytes);
+        auto add = [s](std::atomic<std::int64_t>& a, std::int64_t by) {
+            if(s==&account_registry().orphans) a.fetch_add(by, std::memory_order_relaxed);
+            else a.store(a.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+        };
+        add(c->objects, sign);
+        add(c->object_bytes, sign * obj);
+        add(c->blocks, sign);
+        add(c->block_bytes, sign * static_cast<std::int64_t>(tag.block_bytes));
+    }
+
+    template<class T>
+    void account_new(AccountTag& tag, std::size_t block_bytes, bool array, std::size_t length) noexcept {
+        using U = typename std::remove_cv<T>::type;
+        static const std::uint32_t object_row  = account_row(&type_name<U>, sizeof(U), false, 0);
+        static const std::uint32_t unknown_row = account_row(&type_name<U>, sizeof(U), true, 0);
+        std::uint32_t row;
+        if(!array)        row = object_row;
+        else if(!length)  row = unknown_row;
+        else              row = account_row(&type_name<U>, sizeof(U), true, length);   // one lock per array
+        tag.row = row;
+        tag.block_bytes = static_cast<std::uint32_t>(block_bytes);
+        if(row!=kNoRow) account_add(tag, +1);
+    }
+
+    inline void account_delete(const AccountTag& tag) noexcept {
+        if(tag.row!=kNoRow) account_add(tag, -1);
+    }
+}
+
+// Live totals per row, summed over all threads; rows with nothing live
+// are left out.  Totals are exact once no block is being created or
+// released concurrently.
+inline std::vector<MemoryAccount> memory_snapshot() {
+    detail::AccountRegistry& r = detail::account_registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    const std::uint32_t rows = r.row_count.load(std::memory_order_acquire);
+    std::vector<MemoryAccount> out;
+    std::vector<const detail::AccountShard*> shards(r.shards.begin(), r.shards.end());
+    shards.push_back(&r.orphans);
+    for(std::uint32_t i = 0; i < rows; ++i) {
+        const detail::AccountRow& row = r.rows[i];
+        MemoryAccount a{row.type(), row.array, row.length, 0, 0, 0, 0};
+        for(const detail::AccountShard* s : shards) {
+            const detail::AccountCounters* c = s->chunks[i / detail::kAccountChunk].load(std::memory_order_acquire);
+            if(!c) continue;
+            c += i % detail::kAccountChunk;
+            a.objects      += c->objects.load(std::memory_order_relaxed);
+            a.object_bytes += c->object_bytes.load(std::memory_order_relaxed);
+            a.blocks       += c->blocks.load(std::memory_order_relaxed);
+            a.block_bytes  += c->block_bytes.load(std::memory_order_relaxed);
+        }
+        if(a.objects || a.blocks) out.push_back(std::move(a));
+    }
+    return out;
+}
+
+inline void print_memory_snapshot(std::FILE* out = stdout) {
+    std::fprintf(out, "%-32s %10s %10s %14s %14s\n", "type", "length", "objects", "object bytes", "block bytes");
+    for(const MemoryAccount& a : memory_snapshot()) {
+        std::string name = a.array ? a.type + "[]" : a.type;
+        if(a.array && a.length) std::fprintf(out, "%-32s %10zu", name.c_str(), a.length);
+        else                    std::fprintf(out, "%-32s %10s", name.c_str(), a.array ? "?" : "-");
+        std::fprintf(out, " %10lld %14lld %14lld\n", (long long)a.objects, (long long)a.object_bytes, (long long)a.block_bytes);
+    }
+}
+
+#endif // MEMORY_ACCOUNTING_H
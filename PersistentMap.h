@@ -0,0 +1,191 @@
+#ifndef PERSISTENT_MAP_H
+#define PERSISTENT_MAP_H
+
+#include <bitset>       // popcount
+#include <cstddef>      // std::size_t
+#include <cstdint>      // std::uint32_t
+#include <functional>   // std::hash, std::equal_to
+#include <utility>      // std::move, std::exchange, std::swap
+#include <vector>
+#include "SharedPtr.h"
+
+// =========================== PersistentMap ===========================
+// Immutable hash array mapped trie (CHAMP layout).  Every node keeps
+// two 32-bit bitmaps — one for inline entries, one for SharedPtr<Node>
+// children — so insert/erase/find walk O(log32 n) levels.  A new version
+// shares every untouched subtree with the old one.
+//
+// As in PersistentVector, path copying is decided by unique(): edits clone
+// the nodes they do not own exclusively, so a Transient (or an rvalue map)
+// mutates in place once it owns the path.  Keys whose full hashes collide
+// end up in a collision node (a plain list) below the last hash level.
+
+template<class K, class V, class Hash = std::hash<K>, class Eq = std::equal_to<K>>
+class PersistentMap {
+    static constexpr unsigned    Bits     = 5;
+    static constexpr std::size_t Mask     = (std::size_t(1) << Bits) - 1;
+    static constexpr unsigned    HashBits = sizeof(std::size_t) * 8;
+
+    struct Entry {
+        std::size_t hash;
+        K           key;
+        V           value;
+    };
+    struct Node {
+        std::uint32_t                datamap = 0;   // bit set → entry inline
+        std::uint32_t                nodemap = 0;   // bit set → child subtree
+        std::vector<Entry>           data;          // collision nodes use only this
+        std::vector<SharedPtr<Node>> kids;
+    };
+
+public:
+    class Transient;
+
+    PersistentMap() = default;
+    PersistentMap(const PersistentMap&) = default;
+    PersistentMap(PersistentMap&& o) noexcept : size_(std::exchange(o.size_, 0)), root_(std::move(o.root_)) {}
+    PersistentMap& operator=(const PersistentMap&) = default;
+    PersistentMap& operator=(PersistentMap&& r) noexcept { PersistentMap(std::move(r)).swap(*this); return *this; }
+    void swap(PersistentMap& o) noexcept { std::swap(size_, o.size_); root_.swap(o.root_); }
+
+    //‑‑ observers ‑‑//
+    std::size_t size()  const noexcept { return size_; }
+    bool        empty() const noexcept { return size_==0; }
+    bool contains(const K& key) const { return find(key)!=nullptr; }
+
+    // Walks raw pointers: the map holds the path, so no counter traffic.
+    const V* find(const K& key) const {
+        std::size_t h = Hash{}(key);
+        const Node* n = root_.get();
+        for(unsigned shift = 0; n; shift += Bits) {
+            if(shift >= HashBits) {
+                for(const Entry& e : n->data) if(Eq{}(e.key, key)) return &e.value;
+                return nullptr;
+            }
+            std::uint32_t bit = bit_for(h, shift);
+            if(n->datamap & bit) { const Entry& e = n->data[index(n->datamap, bit)]; return e.hash==h && Eq{}(e.key, key) ? &e.value : nullptr; }
+            if(!(n->nodemap & bit)) return nullptr;
+            n = n->kids[index(n->nodemap, bit)].get();
+        }
+        return nullptr;
+    }
+
+    template<class F> void for_each(F&& f) const { if(root_) visit(*root_, f); }
+
+    //‑‑ persistent updates: *this is left untouched ‑‑//
+    PersistentMap insert(K key, V value) const& { PersistentMap r(*this); r.insert_in_place(std::move(key), std::move(value)); return r; }
+    PersistentMap insert(K key, V value) &&     { insert_in_place(std::move(key), std::move(value)); return std::move(*this); }
+    PersistentMap erase(const K& key) const&    { if(!contains(key)) return *this; PersistentMap r(*this); r.erase_in_place(key); return r; }
+    PersistentMap erase(const K& key) &&        { erase_in_place(key); return std::move(*this); }
+
+    Transient transient() const& { return Transient(*this); }
+    Transient transient() &&     { return Transient(std::move(*this)); }
+
+private:
+    std::size_t     size_ = 0;
+    SharedPtr<Node> root_;
+
+    static std::uint32_t bit_for(std::size_t h, unsigned shift) noexcept { return std::uint32_t(1) << ((h >> shift) & Mask); }
+    static std::size_t   index(std::uint32_t map, std::uint32_t bit) noexcept {
+        return std::bitset<32>(map & (bit - 1)).count();
+    }
+
+    static Node& editable(SharedPtr<Node>& p) {
+        if(!p)               p = SharedPtr<Node>(new Node);
+        else if(!p.unique()) p = SharedPtr<Node>(new Node(*p));
+        return *p;
+    }
+
+    void insert_in_place(K key, V value) {
+        std::size_t h = Hash{}(key);
+        if(insert(root_, 0, Entry{h, std::move(key), std::move(value)})) ++size_;
+    }
+    void erase_in_place(const K& key) {
+        if(!contains(key)) return;
+        erase(root_, 0, Hash{}(key), key);
+        --size_;
+    }
+
+    // returns true if the key was new
+    static bool insert(SharedPtr<Node>& slot, unsigned shift, Entry e) {
+        Node& n = editable(slot);
+        if(shift >= HashBits) {
+            for(Entry& x : n.data) if(Eq{}(x.key, e.key)) { x.value = std::move(e.value); return false; }
+            n.data.push_back(std::move(e));
+            return true;
+        }
+        std::uint32_t bit = bit_for(e.hash, shift);
+        if(n.datamap & bit) {
+            std::size_t i = index(n.datamap, bit);
+            if(n.data[i].hash==e.hash && Eq{}(n.data[i].key, e.key)) { n.data[i].value = std::move(e.value); return false; }
+            // two keys share this slot: push both one level down
+            SharedPtr<Node> sub;
+            insert(sub, shift + Bits, std::move(n.data[i]));
+            insert(sub, shift + Bits, std::move(e));
+            n.data.erase(n.data.begin() + i);
+            n.datamap ^= bit;
+            n.nodemap |= bit;
+            n.kids.insert(n.kids.begin() + index(n.nodemap, bit), std::move(sub));
+            return true;
+        }
+        if(n.nodemap & bit) return insert(n.kids[index(n.nodemap, bit)], shift + Bits, std::move(e));
+        n.datamap |= bit;
+        n.data.insert(n.data.begin() + index(n.datamap, bit), std::move(e));
+        return true;
+    }
+
+    // the key is known to be present
+    static void erase(SharedPtr<Node>& slot, unsigned shift, std::size_t h, const K& key) {
+        Node& n = editable(slot);
+        if(shift >= HashBits) {
+            for(std::size_t i = 0; i < n.data.size(); ++i)
+                if(Eq{}(n.data[i].key, key)) { n.data.erase(n.data.begin() + i); break; }
+        } else {
+            std::uint32_t bit = bit_for(h, shift);
+            if(n.datamap & bit) {
+                n.data.erase(n.data.begin() + index(n.datamap, bit));
+                n.datamap ^= bit;
+            } else {
+                std::size_t ki = index(n.nodemap, bit);
+                erase(n.kids[ki], shift + Bits, h, key);
+                const Node* child = n.kids[ki].get();
+                if(!child || (child->kids.empty() && child->data.size()==1)) {
+                    // keep the trie canonical: pull a lone entry back up
+                    if(child) {
+                        Entry up = child->data.front();
+                        n.datamap |= bit;
+                        n.data.insert(n.data.begin() + index(n.datamap, bit), std::move(up));
+                    }
+                    n.kids.erase(n.kids.begin() + ki);
+                    n.nodemap ^= bit;
+                }
+            }
+        }
+        if(n.data.empty() && n.kids.empty()) slot.reset();
+    }
+
+    template<class F> static void visit(const Node& n, F& f) {
+        for(const Entry& e : n.data) f(e.key, e.value);
+        for(const SharedPtr<Node>& k : n.kids) visit(*k, f);
+    }
+};
+
+// Batch-edit mode: inserts and erases mutate the nodes the transient owns
+// exclusively.  persistent() freezes the result back into a map.
+template<class K, class V, class Hash, class Eq>
+class PersistentMap<K, V, Hash, Eq>::Transient {
+public:
+    explicit Transient(PersistentMap m) noexcept : m_(std::move(m)) {}
+
+    std::size_t size() const noexcept { return m_.size(); }
+    const V* find(const K& key) const { return m_.find(key); }
+    Transient& insert(K key, V value) { m_.insert_in_place(std::move(key), std::move(value)); return *this; }
+    Transient& erase(const K& key)    { m_.erase_in_place(key); return *this; }
+
+    PersistentMap persistent() && noexcept { return std::move(m_); }
+
+private:
+    PersistentMap m_;
+};
+
+#endif // PERSISTENT_MAP_H
@@ -0,0 +1,175 @@
+#ifndef PERSISTENT_VECTOR_H
+#define PERSISTENT_VECTOR_H
+
+#include <cstddef>      // std::size_t
+#include <new>          // placement new
+#include <stdexcept>    // std::out_of_range
+#include <utility>      // std::move, std::exchange, std::swap
+#include "SharedPtr.h"
+
+// ======================== PersistentVector ===========================
+// Immutable vector: a 32-ary radix trie of SharedPtr<Node> interior
+// nodes over SharedPtr<T[]> leaves of 32 elements, plus a tail leaf for
+// O(1) amortised push_back.  An update copies only the O(log32 n) nodes on
+// the path to the changed slot; every other node is shared with the
+// previous version.
+//
+// Path copying is driven by unique(): an update walks down from the root
+// and clones every node it does not own exclusively.  A fresh version
+// shares its root with the old one, so it clones the whole path; a
+// Transient (or an rvalue vector) owns its path after the first edit and
+// from then on mutates in place.
+//
+// T must be default-constructible and copy-assignable (leaves are T[32]).
+
+template<class T>
+class PersistentVector {
+    static constexpr unsigned    Bits  = 5;
+    static constexpr std::size_t Width = std::size_t(1) << Bits;
+    static constexpr std::size_t Mask  = Width - 1;
+
+    // One array of child handles per node: leaves at the bottom interior
+    // level (shift == Bits), nodes above it.  `leafy` says which member is
+    // live, for the copy and the destructor, which do not know the level.
+    struct Node {
+        const bool leafy;
+        union {
+            SharedPtr<Node> kids[Width];
+            SharedPtr<T[]>  leaves[Width];
+        };
+        explicit Node(bool l) noexcept : leafy(l) {
+            for(std::size_t i = 0; i < Width; ++i) { if(leafy) ::new (&leaves[i]) SharedPtr<T[]>(); else ::new (&kids[i]) SharedPtr<Node>(); }
+        }
+        Node(const Node& o) noexcept : leafy(o.leafy) {
+            for(std::size_t i = 0; i < Width; ++i) { if(leafy) ::new (&leaves[i]) SharedPtr<T[]>(o.leaves[i]); else ::new (&kids[i]) SharedPtr<Node>(o.kids[i]); }
+        }
+        Node& operator=(const Node&) = delete;
+        ~Node() { for(std::size_t i = 0; i < Width; ++i) { if(leafy) leaves[i].~SharedPtr(); else kids[i].~SharedPtr(); } }
+    };
+
+public:
+    class Transient;
+
+    PersistentVector() noexcept = default;
+    PersistentVector(const PersistentVector&) = default;
+    PersistentVector(PersistentVector&& o) noexcept
+        : size_(std::exchange(o.size_, 0)), shift_(std::exchange(o.shift_, Bits)), root_(std::move(o.root_)), tail_(std::move(o.tail_)) {}
+    PersistentVector& operator=(const PersistentVector&) = default;
+    PersistentVector& operator=(PersistentVector&& r) noexcept { PersistentVector(std::move(r)).swap(*this); return *this; }
+
+    void swap(PersistentVector& o) noexcept {
+        std::swap(size_, o.size_); std::swap(shift_, o.shift_); root_.swap(o.root_); tail_.swap(o.tail_);
+    }
+
+    //‑‑ observers ‑‑//
+    std::size_t size()  const noexcept { return size_; }
+    bool        empty() const noexcept { return size_==0; }
+    const T& operator[](std::size_t i) const { assert(i<size_); return leaf_for(i)[i & Mask]; }
+    const T& at(std::size_t i) const { if(i>=size_) throw std::out_of_range("PersistentVector::at"); return (*this)[i]; }
+
+    template<class F> void for_each(F&& f) const {
+        for(std::size_t i = 0; i < size_; i += Width) {
+            const SharedPtr<T[]>& leaf = leaf_for(i);
+            for(std::size_t j = 0; j < Width && i + j < size_; ++j) f(leaf[j]);
+        }
+    }
+
+    //‑‑ persistent updates: *this is left untouched ‑‑//
+    PersistentVector push_back(T v) const& { PersistentVector r(*this); r.push_back_in_place(std::move(v)); return r; }
+    PersistentVector push_back(T v) &&     { push_back_in_place(std::move(v)); return std::move(*this); }
+    PersistentVector set(std::size_t i, T v) const& { PersistentVector r(*this); r.set_in_place(i, std::move(v)); return r; }
+    PersistentVector set(std::size_t i, T v) &&     { set_in_place(i, std::move(v)); return std::move(*this); }
+
+    Transient transient() const& { return Transient(*this); }
+    Transient transient() &&     { return Transient(std::move(*this)); }
+
+private:
+    std::size_t     size_  = 0;
+    unsigned        shift_ = Bits;
+    SharedPtr<Node> root_;
+    SharedPtr<T[]>  tail_;
+
+    std::size_t tail_offset() const noexcept { return size_ < Width ? 0 : ((size_ - 1) >> Bits) << Bits; }
+
+    const SharedPtr<T[]>& leaf_for(std::size_t i) const {
+        if(i >= tail_offset()) return tail_;
+        const Node* n = root_.get();
+        for(unsigned level = shift_; level > Bits; level -= Bits) n = n->kids[(i >> level) & Mask].get();
+        return n->leaves[(i >> Bits) & Mask];
+    }
+
+    // Returns a node/leaf this vector may mutate: kept if unique(), else
+    // cloned (or created, for an empty slot; `leafy` for the bottom level).
+    static Node& editable(SharedPtr<Node>& p, bool leafy) {
+        if(!p)                p = SharedPtr<Node>(new Node(leafy));
+        else if(!p.unique())  p = SharedPtr<Node>(new Node(*p));
+        return *p;
+    }
+    static SharedPtr<T[]>& editable(SharedPtr<T[]>& p, std::size_t used) {
+        if(!p) p = SharedPtr<T[]>(new T[Width]);
+        else if(!p.unique()) {
+            SharedPtr<T[]> c(new T[Width]);
+            for(std::size_t i = 0; i < used; ++i) c[i] = p[i];
+            p = std::move(c);
+        }
+        return p;
+    }
+
+    void push_back_in_place(T v) {
+        std::size_t in_tail = size_ - tail_offset();
+        if(in_tail < Width) { editable(tail_, in_tail)[in_tail] = std::move(v); ++size_; return; }
+
+        // tail is full: move it into the trie, growing a level if the root
+        // is full, and start a new tail with v.  Everything that can throw
+        // runs before the old tail leaves tail_.  A throw may leave a grown
+        // root or cloned path behind, but they hold the same elements, so
+        // size_, tail_ and the trie still agree.
+        SharedPtr<T[]> next(new T[Width]);
+        next[0] = std::move(v);
+        if((size_ >> Bits) > (std::size_t(1) << shift_)) {
+            SharedPtr<Node> up(new Node(false));
+            up->kids[0] = std::move(root_);
+            root_ = std::move(up);
+            shift_ += Bits;
+        }
+        push_tail(root_, shift_, tail_);
+        tail_ = std::move(next);
+        ++size_;
+    }
+    // Moves `leaf` into the trie once the path to its slot is editable.
+    void push_tail(SharedPtr<Node>& slot, unsigned level, SharedPtr<T[]>& leaf) {
+        Node& n = editable(slot, level==Bits);
+        std::size_t sub = ((size_ - 1) >> level) & Mask;
+        if(level==Bits) n.leaves[sub] = std::move(leaf);
+        else            push_tail(n.kids[sub], level - Bits, leaf);
+    }
+
+    void set_in_place(std::size_t i, T v) {
+        if(i>=size_) throw std::out_of_range("PersistentVector::set");
+        std::size_t off = tail_offset();
+        if(i >= off) { editable(tail_, size_ - off)[i & Mask] = std::move(v); return; }
+        SharedPtr<Node>* slot = &root_;
+        for(unsigned level = shift_; level > Bits; level -= Bits) slot = &editable(*slot, false).kids[(i >> level) & Mask];
+        editable(editable(*slot, true).leaves[(i >> Bits) & Mask], Width)[i & Mask] = std::move(v);
+    }
+};
+
+// Batch-edit mode: mutations happen in place on nodes the transient owns
+// exclusively.  persistent() freezes the result back into a vector.
+template<class T>
+class PersistentVector<T>::Transient {
+public:
+    explicit Transient(PersistentVector v) noexcept : v_(std::move(v)) {}
+
+    std::size_t size() const noexcept { return v_.size(); }
+    const T& operator[](std::size_t i) const { return v_[i]; }
+    Transient& push_back(T v)            { v_.push_back_in_place(std::move(v)); return *this; }
+    Transient& set(std::size_t i, T v)   { v_.set_in_place(i, std::move(v)); return *this; }
+
+    PersistentVector persistent() && noexcept { return std::move(v_); }
+
+private:
+    PersistentVector v_;
+};
+
+#endif // PERSISTENT_VECTOR_H
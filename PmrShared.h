@@ -0,0 +1,70 @@
+#ifndef PMR_SHARED_H
+#define PMR_SHARED_H
+
+#include <cstddef>          // std::size_t, std::max_align_t
+#include <memory>           // std::allocator_traits
+#include <memory_resource>
+#include <new>              // placement new
+#include <utility>          // std::forward
+#include "SharedPtr.h"
+
+// ========================= std::pmr factories ========================
+// make_pmr_shared<T>(resource, args...) and make_pmr_shared_array<T>(
+// resource, n) take the control block and the object(s) from one
+// allocation out of a std::pmr::memory_resource, chosen at run time, and
+// hand it back to the same resource on the final release.  The resource
+// must outlive every handle.
+//
+// Objects are built through polymorphic_allocator, so allocator-aware
+// members (std::pmr::string, std::pmr::vector, …) draw from the same
+// resource.  A monotonic_buffer_resource never gives memory back before
+// it is destroyed; that is its design, not a leak.
+
+template<class T, class... Args>
+SharedPtr<T> make_pmr_shared(std::pmr::memory_resource* r, Args&&... args) {
+    return allocate_shared_ptr<T>(std::pmr::polymorphic_allocator<T>(r), std::forward<Args>(args)...);
+}
+
+namespace detail {
+    // Block header followed by n elements in the same allocation.
+    template<class T>
+    struct PmrArrayBlock : HookedBlock<T*> {
+        std::pmr::memory_resource* resource;
+        std::size_t                n;
+
+        static constexpr std::size_t kAlign  = alignof(T) > alignof(HookedBlock<T*>) ? alignof(T) : alignof(HookedBlock<T*>);
+        static constexpr std::size_t offset() noexcept { return (sizeof(PmrArrayBlock) + alignof(T) - 1) / alignof(T) * alignof(T); }
+        static std::size_t bytes(std::size_t n) noexcept { return offset() + n * sizeof(T); }
+
+        PmrArrayBlock(std::pmr::memory_resource* r, std::size_t count) noexcept
+            : HookedBlock<T*>(reinterpret_cast<T*>(reinterpret_cast<unsigned char*>(this) + offset()), &dispose),
+              resource(r), n(count) {}
+
+        static void destroy_elements(T* p, std::size_t n) noexcept { while(n) p[--n].~T(); }
+        static void dispose(ControlBlock<T*>* cb) noexcept {
+            auto* b = static_cast<PmrArrayBlock*>(cb);
+            std::pmr::memory_resource* r = b->resource;
+            const std::size_t size = bytes(b->n);
+            destroy_elements(cb->ptr, b->n);
+            b->~PmrArrayBlock();
+            r->deallocate(b, size, kAlign);
+        }
+    };
+}
+
+// n value-initialised elements after the block, in one allocation from `r`.
+template<class T>
+SharedPtr<T[]> make_pmr_shared_array(std::pmr::memory_resource* r, std::size_t n) {
+    using Block = detail::PmrArrayBlock<T>;
+    if(n==0) return SharedPtr<T[]>();
+    if(n > (std::size_t(-1) - Block::offset()) / sizeof(T)) throw std::bad_array_new_length();
+    void* mem = r->allocate(Block::bytes(n), Block::kAlign);
+    Block* b = ::new (mem) Block(r, n);
+    std::pmr::polymorphic_allocator<T> a(r);
+    std::size_t built = 0;
+    try { for(; built < n; ++built) std::allocator_traits<std::pmr::polymorphic_allocator<T>>::construct(a, b->ptr + built); }
+    catch(...) { Block::destroy_elements(b->ptr, built); b->~Block(); r->deallocate(mem, Block::bytes(n), Block::kAlign); throw; }
+    return detail::SharedPtrAccess::adopt<SharedPtr<T[]>>(detail::accounted<T>(b, true, n, Block::offset()));
+}
+
+#endif // PMR_SHARED_H
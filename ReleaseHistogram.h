@@ -0,0 +1,214 @@
+#ifndef RELEASE_HISTOGRAM_H
+#define RELEASE_HISTOGRAM_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>      // std::uint64_t
+#include <cstdio>       // std::FILE, std::fprintf
+#include <memory>       // std::unique_ptr
+#include <mutex>
+#include <string>
+#include <type_traits>  // std::remove_pointer
+#include <vector>
+#include "SharedPtr.h"
+#include "TypeName.h"
+
+// ====================== Release-latency histograms ===================
+// With -DSHPTR_RELEASE_TIMING every final release (destructor plus block
+// deallocation, or the dispose hook) is timed and recorded under the
+// pointee type.  Without the macro SharedPtr.h contains no timing code.
+//
+// Each thread records into its own shard of histograms, one per type, with
+// relaxed single-writer stores: no locks or shared cache lines on the
+// release path.  The registry mutex is only taken the first time a thread
+// (or a type) shows up, and by release_latency_report().  Members a
+// destructor drops are released after it returns (iterative teardown), so
+// each is charged to its own type, not to the owner's.
+//
+// ReleaseHistogram is log-linear in the HDR style: exact below 16 ns, then
+// 16 sub-buckets per power of two, i.e. at most 6.25 % relative error.
+
+class ReleaseHistogram {
+public:
+    static constexpr unsigned SubBits = 4;
+    static constexpr unsigned Sub     = 1u << SubBits;
+    static constexpr unsigned Buckets = (64 - SubBits + 1) * Sub;
+
+    // single writer (the owning thread); readers may run concurrently
+    void record(std::uint64_t ns) noexcept {
+        bump(counts_[index(ns)], 1);
+        bump(total_, 1);
+        if(ns > max_.load(std::memory_order_relaxed)) max_.store(ns, std::memory_order_relaxed);
+    }
+    void merge(const ReleaseHistogram& o) noexcept {
+        for(unsigned i = 0; i < Buckets; ++i) bump(counts_[i], o.counts_[i].load(std::memory_order_relaxed));
+        bump(total_, o.total_.load(std::memory_order_relaxed));
+        if(o.max() > max()) max_.store(o.max(), std::memory_order_relaxed);
+    }
+    void clear() noexcept {
+        for(auto& c : counts_) c.store(0, std::memory_order_relaxed);
+        total_.store(0, std::memory_order_relaxed); max_.store(0, std::memory_order_relaxed);
+    }
+
+    std::uint64_t count() const noexcept { return total_.load(std::memory_order_relaxed); }
+    std::uint64_t max()   const noexcept { return max_.load(std::memory_order_relaxed); }
+
+    // Smallest recorded bucket bound with at least q (0..1) of the samples at or below it.
+    std::uint64_t percentile(double q) const noexcept {
+        const std::uint64_t n = count();
+        if(n==0) return 0;
+        const std::uint64_t want = q >= 1 ? n : static_cast<std::uint64_t>(q * static_cast<double>(n)) + 1;
+        std::uint64_t seen = 0;
+        for(unsigned i = 0; i < Buckets; ++i) {
+            seen += counts_[i].load(std::memory_order_relaxed);
+            if(seen >= want) { std::uint64_t hi = upper(i); return hi < max() ? hi : max(); }
+        }
+        return max();
+    }
+
+    static unsigned index(std::uint64_t v) noexcept {
+        if(v < Sub) return static_cast<unsigned>(v);
+        unsigned e = log2_floor(v);
+        return (e - SubBits + 1) * Sub + static_cast<unsigned>((v >> (e - SubBits)) & (Sub - 1));
+    }
+    static std::uint64_t lower(unsigned i) noexcept {
+        if(i < Sub) return i;
+        unsigned e = i / Sub - 1 + SubBits;
+        return (std::uint64_t(Sub) + i % Sub) << (e - SubBits);
+    }
+    static std::uint64_t upper(unsigned i) noexcept { return i + 1 < Buckets ? lower(i + 1) - 1 : ~std::uint64_t(0); }
+
+private:
+    std::atomic<std::uint64_t> counts_[Buckets] = {};
+    std::atomic<std::uint64_t> total_{0};
+    std::atomic<std::uint64_t> max_{0};
+
+    static void bump(std::atomic<std::uint64_t>& c, std::uint64_t by) noexcept {
+        c.store(c.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+    static unsigned log2_floor(std::uint64_t v) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+        return 63u - static_cast<unsigned>(__builtin_clzll(v));
+#else
+        unsigned e = 0;
+        while(v >>= 1) ++e;
+        return e;
+#endif
+    }
+};
+
+// Percentiles of one type, merged over all threads (nanoseconds).
+struct ReleaseStats {
+    std::string   type;
+    std::uint64_t count;
+    std::uint64_t p50, p90, p99, p999, max;
+};
+
+namespace detail {
+    struct TimingShard {
+        std::vector<std::unique_ptr<ReleaseHistogram>> hists;   // by type index; grown under the mutex
+        bool in_use = false;
+    };
+    struct TimingRegistry {
+        std::mutex                mutex;
+        std::vector<std::string>  types;
+        std::vector<TimingShard*> shards;                       // never freed: reused by later threads
+    };
+    // Leaked on purpose: releases may still run during static destruction.
+    inline TimingRegistry& timing_registry() { static TimingRegistry* r = new TimingRegistry; return *r; }
+
+    constexpr std::size_t kNoType = ~std::size_t(0);
+
+    template<class P>
+    std::size_t release_type_index() noexcept {
+        static const std::size_t idx = [] {
+            try {
+                TimingRegistry& r = timing_registry();
+                std::string name = type_name<typename std::remove_pointer<P>::type>();
+                std::lock_guard<std::mutex> lock(r.mutex);
+                r.types.push_back(std::move(name));
+                return r.types.size() - 1;
+            } catch(...) { return kNoType; }
+        }();
+        return idx;
+    }
+
+    // The calling thread's shard; its lease frees the shard for reuse at
+    // thread exit.  Releases that run after that are not recorded.
+    struct ShardLease {
+        TimingShard* shard = nullptr;
+        ~ShardLease();
+    };
+    inline thread_local bool shard_retired = false;   // trivially destructible: safe to read at thread exit
+
+    inline TimingShard* acquire_shard() {
+        TimingRegistry& r = timing_registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for(TimingShard* s : r.shards) if(!s->in_use) { s->in_use = true; return s; }
+        r.shards.push_back(new TimingShard);
+        r.shards.back()->in_use = true;
+        return r.shards.back();
+    }
+    inline ShardLease::~ShardLease() {
+        shard_retired = true;
+        if(!shard) return;
+        std::lock_guard<std::mutex> lock(timing_registry().mutex);
+        shard->in_use = false;
+    }
+
+    inline ReleaseHistogram* release_histogram(std::size_t type) noexcept {
+        if(type==kNoType || shard_retired) return nullptr;
+        static thread_local ShardLease lease;
+        try {
+            if(!lease.shard) lease.shard = acquire_shard();
+            auto& hists = lease.shard->hists;
+            if(type >= hists.size() || !hists[type]) {
+                auto h = std::unique_ptr<ReleaseHistogram>(new ReleaseHistogram);
+                std::lock_guard<std::mutex> lock(timing_registry().mutex);
+                if(type >= hists.size()) hists.resize(type + 1);
+                hists[type] = std::move(h);
+            }
+            return hists[type].get();
+        } catch(...) { return nullptr; }
+    }
+
+    template<class P>
+    void record_release(std::chrono::steady_clock::time_point start) noexcept {
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        if(ReleaseHistogram* h = release_histogram(release_type_index<P>())) h->record(static_cast<std::uint64_t>(ns));
+    }
+}
+
+// Merges every thread's shard; types with no releases are skipped.
+inline std::vector<ReleaseStats> release_latency_report() {
+    detail::TimingRegistry& r = detail::timing_registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    std::vector<ReleaseStats> out;
+    for(std::size_t t = 0; t < r.types.size(); ++t) {
+        std::unique_ptr<ReleaseHistogram> sum(new ReleaseHistogram);
+        for(const detail::TimingShard* s : r.shards)
+            if(t < s->hists.size() && s->hists[t]) sum->merge(*s->hists[t]);
+        if(sum->count()==0) continue;
+        out.push_back({r.types[t], sum->count(), sum->percentile(0.50), sum->percentile(0.90),
+                       sum->percentile(0.99), sum->percentile(0.999), sum->max()});
+    }
+    return out;
+}
+
+// Clears all histograms (concurrent releases may land on either side).
+inline void release_latency_reset() {
+    detail::TimingRegistry& r = detail::timing_registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for(detail::TimingShard* s : r.shards)
+        for(auto& h : s->hists) if(h) h->clear();
+}
+
+inline void print_release_latency(std::FILE* out = stdout) {
+    std::fprintf(out, "%-32s %10s %9s %9s %9s %9s %9s\n", "type (final releases, ns)", "count", "p50", "p90", "p99", "p99.9", "max");
+    for(const ReleaseStats& s : release_latency_report())
+        std::fprintf(out, "%-32s %10llu %9llu %9llu %9llu %9llu %9llu\n", s.type.c_str(),
+                     (unsigned long long)s.count, (unsigned long long)s.p50, (unsigned long long)s.p90,
+                     (unsigned long long)s.p99, (unsigned long long)s.p999, (unsigned long long)s.max);
+}
+
+#endif // RELEASE_HISTOGRAM_H
@@ -0,0 +1,129 @@
+#ifndef SHARED_POOL_H
+#define SHARED_POOL_H
+
+#include <atomic>
+#include <cstddef>      // std::size_t
+#include <functional>   // std::function
+#include <new>          // placement new
+#include <thread>       // std::this_thread::get_id
+#include "SharedPtr.h"
+
+// ============================ SharedPool =============================
+// Recycles fixed-type objects *and* their control blocks.  The last
+// release of a pooled SharedPtr<T> runs the optional reset hook and parks
+// the node on the pool's freelist instead of calling `delete`.
+//
+// A pool belongs to the thread that created it (make it `thread_local` for
+// a per-thread freelist): acquire() must be called there.  Handles may be
+// released on any thread; foreign releases go through a lock-free stack
+// that the owner drains on its next miss.  Handles may outlive the pool.
+
+namespace detail {
+    template<class T> struct PoolState;
+
+    template<class T>
+    struct PoolNode : HookedBlock<T*> {
+        PoolState<T>*    state;
+        PoolNode*        next = nullptr;
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        PoolNode(PoolState<T>* s, typename HookedBlock<T*>::Dispose d) noexcept
+            : HookedBlock<T*>(reinterpret_cast<T*>(storage), d), state(s) {}
+        static PoolNode* from(ControlBlock<T*>* cb) noexcept { return static_cast<PoolNode*>(cb); }
+        static void destroy(PoolNode* n) noexcept { n->ptr->~T(); delete n; }
+    };
+
+    template<class T>
+    struct PoolState {
+        using Node = PoolNode<T>;
+
+        std::atomic<Node*>       remote{nullptr};   // push-only, drained with exchange()
+        std::atomic<std::size_t> refs{1};           // the pool + every node handed out
+        std::atomic<bool>        closed{false};
+        std::thread::id          owner = std::this_thread::get_id();
+        std::function<void(T&)>  reset;
+        std::size_t              capacity;
+        Node*                    local = nullptr;   // owner-thread freelist
+        std::size_t              local_size = 0;
+
+        PoolState(std::size_t cap, std::function<void(T&)> r) : reset(std::move(r)), capacity(cap) {}
+
+        void push_remote(Node* n) noexcept {
+            n->next = remote.load(std::memory_order_relaxed);
+            while(!remote.compare_exchange_weak(n->next, n, std::memory_order_release, std::memory_order_relaxed)) {}
+        }
+        static void destroy_list(Node* n) noexcept { while(n){ Node* nx=n->next; Node::destroy(n); n=nx; } }
+        void unref() noexcept {
+            if(refs.fetch_sub(1, std::memory_order_acq_rel)!=1) return;
+            destroy_list(remote.exchange(nullptr, std::memory_order_acquire));
+            delete this;
+        }
+    };
+}
+
+template<class T>
+class SharedPool {
+    using Node  = detail::PoolNode<T>;
+    using State = detail::PoolState<T>;
+public:
+    explicit SharedPool(std::size_t capacity = 1024, std::function<void(T&)> reset = {})
+        : st_(new State(capacity, std::move(reset))) {}
+    SharedPool(const SharedPool&) = delete;
+    SharedPool& operator=(const SharedPool&) = delete;
+
+    ~SharedPool() {
+        st_->closed.store(true, std::memory_order_release);
+        State::destroy_list(st_->local);
+        State::destroy_list(st_->remote.exchange(nullptr, std::memory_order_acquire));
+        st_->local = nullptr; st_->local_size = 0;
+        st_->unref();
+    }
+
+    // Returns a recycled object if one is cached, otherwise a new T().
+    SharedPtr<T> acquire() {
+        assert(std::this_thread::get_id()==st_->owner);
+        Node* n = pop_local();
+        if(!n){ refill(); n = pop_local(); }
+        if(!n){
+            n = new Node(st_, &recycle);
+            try { ::new (static_cast<void*>(n->storage)) T(); } catch(...) { delete n; throw; }
+        }
+        n->ref_cnt = 1 | detail::kHooked;
+        st_->refs.fetch_add(1, std::memory_order_relaxed);
+        return detail::SharedPtrAccess::adopt<SharedPtr<T>>(detail::accounted<T>(n, false, 0, sizeof(Node) - sizeof(T)));
+    }
+
+    std::size_t cached()   const noexcept { return st_->local_size; }
+    std::size_t capacity() const noexcept { return st_->capacity; }
+
+private:
+    State* st_;
+
+    Node* pop_local() noexcept {
+        Node* n = st_->local;
+        if(n){ st_->local = n->next; --st_->local_size; }
+        return n;
+    }
+    void refill() noexcept {
+        Node* n = st_->remote.exchange(nullptr, std::memory_order_acquire);
+        while(n){ Node* nx=n->next; if(!push_owner(st_, n)) Node::destroy(n); n=nx; }
+    }
+
+    // dispose hook: runs on whichever thread dropped the last reference
+    static void recycle(detail::ControlBlock<T*>* cb) noexcept {
+        Node*  n = Node::from(cb);
+        State* s = n->state;
+        if(s->reset) s->reset(*cb->ptr);
+        if(s->closed.load(std::memory_order_acquire))       Node::destroy(n);
+        else if(std::this_thread::get_id()==s->owner)       { if(!push_owner(s, n)) Node::destroy(n); }
+        else                                                s->push_remote(n);
+        s->unref();
+    }
+    static bool push_owner(State* s, Node* n) noexcept {
+        if(s->local_size>=s->capacity) return false;
+        n->next = s->local; s->local = n; ++s->local_size;
+        return true;
+    }
+};
+
+#endif // SHARED_POOL_H
@@ -1,26 +1,350 @@
 #ifndef SHARED_PTR_H
 #define SHARED_PTR_H
 
+#include <atomic>       // when_released() hooks; the counter itself with SHPTR_THREADSAFE
 #include <cstddef>      // std::nullptr_t, std::size_t
+#include <cstdlib>      // std::malloc, std::free
+#include <cstring>      // std::memcpy
 #include <utility>      // std::swap, std::move
 #include <cassert>
+#include <cstdint>      // std::uint32_t
+#include <memory>       // std::allocator_traits
+#include <new>          // placement new, std::launder
+#include <type_traits>  // std::is_empty, std::is_final
+
+// Counter width: -DSHPTR_COUNT32 selects a 32-bit counter word.
+#ifdef SHPTR_COUNT32
+  using ref_value_t = std::uint32_t;
+#else
+  using ref_value_t = std::size_t;
+#endif
 #ifdef SHPTR_THREADSAFE
-  #include <atomic>
-  using ref_count_t = std::atomic<std::size_t>;
+  #include <thread>     // std::this_thread::yield (wait fallback)
+  using ref_count_t = std::atomic<ref_value_t>;
+  #ifdef __cpp_lib_atomic_wait
+    #define SHPTR_ATOMIC_WAIT 1   // wait_until_count() blocks on the counter (C++20)
+  #endif
 #else
-  using ref_count_t = std::size_t;
+  using ref_count_t = ref_value_t;
+#endif
+
+// -DSHPTR_RELEASE_TIMING times every final release into per-type
+// histograms (ReleaseHistogram.h, included at the end of this header).
+#ifdef SHPTR_RELEASE_TIMING
+  #include <chrono>
 #endif
+// -DSHPTR_SAMPLE_CB samples 1 in N counter updates per control block to
+// find the hottest shared objects (HotBlockSampler.h, included at the end).
+// -DSHPTR_ACCOUNTING tracks live objects and blocks per type
+// (MemoryAccounting.h, included at the end).
 
 // =========================== Control‑block ===========================
 namespace detail {
+    // The counter word packs the strong count with a kind flag in its top
+    // bit, so one atomic RMW both counts and tells release() which path to
+    // take: set for hooked blocks, which own their release.  A 64-bit word
+    // spares two more fields below it.  kParked marks coroutines parked in
+    // when_released(); only the final release looks at it.  With
+    // SHPTR_ATOMIC_WAIT, the 14 bits under that count the threads blocked in
+    // wait_until_count(); release() notifies only while that is non-zero.
+    // A 32-bit word keeps 31 count bits: parked coroutines are announced
+    // through parked_blocks instead, and waiting threads yield.
+    constexpr unsigned    kWordBits    = sizeof(ref_value_t) * 8;
+    constexpr bool        kWideWord    = kWordBits >= 64;
+#ifdef SHPTR_ATOMIC_WAIT
+    constexpr unsigned    kWaiterBits  = kWideWord ? 14 : 0;
+#else
+    constexpr unsigned    kWaiterBits  = 0;
+#endif
+    constexpr ref_value_t kHooked      = ref_value_t(1) << (kWordBits - 1);
+    constexpr ref_value_t kParked      = kWideWord ? ref_value_t(1) << (kWordBits - 2) : 0;
+    constexpr ref_value_t kFlagsLow    = kParked ? kParked : kHooked;
+    constexpr ref_value_t kWaiterOne   = kFlagsLow >> kWaiterBits;        // kFlagsLow: no waiter field
+    constexpr ref_value_t kWaiterMask  = kFlagsLow - kWaiterOne;
+    constexpr ref_value_t kCountMask   = kWaiterOne - 1;
+    static_assert(kWordBits < 64 || kCountMask >= (ref_value_t(1) << 47), "64-bit words keep at least 48 count bits");
+    static_assert(kWordBits >= 64 || kCountMask==kHooked - 1, "32-bit words keep 31 count bits");
+
+#ifdef SHPTR_ACCOUNTING
+    // Which memory-account row a block is charged to, and its overhead.
+    struct AccountTag {
+        std::uint32_t row         = ~std::uint32_t(0);   // untracked
+        std::uint32_t block_bytes = 0;
+    };
+#endif
+
+    // Plain `new` blocks: object pointer + counter, two words.
     template<class P>
     struct ControlBlock {
         P              ptr;
         ref_count_t    ref_cnt;
-        explicit ControlBlock(P p) noexcept : ptr(p), ref_cnt{1} {}
+#ifdef SHPTR_ACCOUNTING
+        AccountTag     acct;
+#endif
+        explicit ControlBlock(P p, ref_value_t flags = 0) noexcept : ptr(p), ref_cnt{1 | flags} {}
+    };
+
+    // Blocks that release themselves (pools, mappings, custom deleters and
+    // allocators …) derive from HookedBlock; the last release calls dispose
+    // instead of the owner's delete / delete[].
+    template<class P>
+    struct HookedBlock : ControlBlock<P> {
+        using Dispose = void (*)(ControlBlock<P>*) noexcept;
+        Dispose dispose;
+        HookedBlock(P p, Dispose d) noexcept : ControlBlock<P>(p, kHooked), dispose(d) {}
+    };
+
+    inline ref_value_t word_of(const ref_count_t& c) noexcept {
+#ifdef SHPTR_THREADSAFE
+        // acquire pairs with the other owners' decrements: whoever sees 1
+        // also sees everything they wrote before letting go (unique() → write)
+        return c.load(std::memory_order_acquire);
+#else
+        return c;
+#endif
+    }
+    template<class P>
+    inline std::size_t count_of(const ControlBlock<P>* cb) noexcept { return cb ? word_of(cb->ref_cnt) & kCountMask : 0; }
+
+    template<class P>
+    inline typename HookedBlock<P>::Dispose dispose_of(const ControlBlock<P>* cb) noexcept {
+        return cb && (word_of(cb->ref_cnt) & kHooked) ? static_cast<const HookedBlock<P>*>(cb)->dispose : nullptr;
+    }
+
+#ifdef SHPTR_RELEASE_TIMING
+    template<class P>
+    void record_release(std::chrono::steady_clock::time_point start) noexcept;   // ReleaseHistogram.h
+#endif
+
+#ifdef SHPTR_ACCOUNTING
+    template<class T>
+    void account_new(AccountTag& tag, std::size_t block_bytes, bool array, std::size_t length) noexcept;   // MemoryAccounting.h
+    inline void account_delete(const AccountTag& tag) noexcept;
+#endif
+
+    // Charges a new block to the memory accounts (SHPTR_ACCOUNTING); `length`
+    // is the element count of an array, 0 if unknown, and `overhead` the
+    // bytes the block adds on top of the object.
+    template<class T, class CB>
+    inline CB* accounted(CB* cb, bool array = false, std::size_t length = 0, std::size_t overhead = sizeof(CB)) noexcept {
+#ifdef SHPTR_ACCOUNTING
+        account_new<T>(cb->acct, overhead, array, length);
+#else
+        (void)array; (void)length; (void)overhead;
+#endif
+        return cb;
+    }
+    template<class T>
+    inline ControlBlock<T*>* new_block(T* p, bool array) { return accounted<T>(new ControlBlock<T*>(p), array); }
+
+    // when_released() (AsyncRelease.h) parks coroutines in a side table and
+    // marks the block with kParked or, on 32-bit words, counts it in
+    // parked_blocks.  destroy() takes them out while the block still exists
+    // (its address cannot be reused yet) and resumes them once it is gone.
+    // Installed by the first when_released().
+    struct ReleaseWaiterHooks {
+        void* (*take)(const void* cb) noexcept;
+        void  (*resume)(void* waiters) noexcept;
+    };
+    inline std::atomic<const ReleaseWaiterHooks*> release_waiter_hooks{nullptr};
+    inline std::atomic<std::size_t> parked_blocks{0};          // blocks with parked coroutines (no kParked)
+
+    // Hands a dead block to its dispose hook or, for plain `new` blocks, to
+    // the owner's deleter `del`.
+    template<class P>
+    inline void destroy(ControlBlock<P>* cb, void (*del)(P)) noexcept {
+#ifdef SHPTR_RELEASE_TIMING
+        const auto start = std::chrono::steady_clock::now();
+#endif
+#ifdef SHPTR_ACCOUNTING
+        account_delete(cb->acct);
+#endif
+        const ref_value_t word = word_of(cb->ref_cnt);
+        const bool parked = kParked ? (word & kParked)!=0 : parked_blocks.load(std::memory_order_acquire)!=0;
+        const ReleaseWaiterHooks* wh = parked ? release_waiter_hooks.load(std::memory_order_acquire) : nullptr;
+        void* waiters = wh ? wh->take(cb) : nullptr;
+        // launder: inlined next to a plain `new` block, GCC would otherwise
+        // flag the wider HookedBlock read as out of bounds (-Warray-bounds)
+        if(word & kHooked) std::launder(static_cast<HookedBlock<P>*>(cb))->dispose(cb);
+        else { del(cb->ptr); delete cb; }
+#ifdef SHPTR_RELEASE_TIMING
+        record_release<P>(start);
+#endif
+        if(waiters) wh->resume(waiters);
+    }
+
+    // Empty-base holder: a stateless deleter or allocator adds no bytes.
+    template<class D, bool = std::is_empty<D>::value && !std::is_final<D>::value>
+    struct EboHolder : private D {
+        explicit EboHolder(D d) : D(std::move(d)) {}
+        D& get() noexcept { return *this; }
+    };
+    template<class D>
+    struct EboHolder<D, false> {
+        D d;
+        explicit EboHolder(D x) : d(std::move(x)) {}
+        D& get() noexcept { return d; }
+    };
+
+    // SharedPtr(p, d): the deleter lives in the block, behind the hook.
+    template<class P, class D>
+    struct DeleterBlock : HookedBlock<P>, EboHolder<D> {
+        DeleterBlock(P p, D d) : HookedBlock<P>(p, &dispose), EboHolder<D>(std::move(d)) {}
+        static void dispose(ControlBlock<P>* cb) noexcept {
+            auto* b = static_cast<DeleterBlock*>(cb);
+            b->get()(cb->ptr);
+            delete b;
+        }
+    };
+    template<class P, class D>
+    ControlBlock<P>* make_deleter_block(P p, D& d, bool array) {
+        try { return accounted<typename std::remove_pointer<P>::type>(new DeleterBlock<P, D>(p, d), array); }
+        catch(...) { d(p); throw; }
+    }
+
+#ifdef SHPTR_SAMPLE_CB
+    template<class P>
+    void sample_block(const ControlBlock<P>* cb, bool increment) noexcept;   // HotBlockSampler.h
+#endif
+
+    // Adds one reference to a live block.
+    template<class P>
+    inline void retain(ControlBlock<P>* cb) noexcept {
+#ifdef SHPTR_SAMPLE_CB
+        sample_block(cb, true);
+#endif
+        const ref_value_t now = ++cb->ref_cnt;
+        assert((now & kCountMask)!=0 && "reference count overflowed into the flag bits");
+        (void)now;
+    }
+
+    // Adds one reference unless the count has already dropped to zero, i.e.
+    // the last release is under way.  For tables that list blocks they do
+    // not own (a weak lock()).
+    template<class P>
+    inline bool try_retain(ControlBlock<P>* cb) noexcept {
+#ifdef SHPTR_THREADSAFE
+        ref_value_t w = cb->ref_cnt.load(std::memory_order_relaxed);
+        do { if((w & kCountMask)==0) return false; }
+        while(!cb->ref_cnt.compare_exchange_weak(w, w + 1, std::memory_order_relaxed));
+        assert(((w + 1) & kCountMask)!=0 && "reference count overflowed into the flag bits");
+#else
+        if((cb->ref_cnt & kCountMask)==0) return false;
+        assert(((cb->ref_cnt + 1) & kCountMask)!=0 && "reference count overflowed into the flag bits");
+        ++cb->ref_cnt;
+#endif
+#ifdef SHPTR_SAMPLE_CB
+        sample_block(cb, true);
+#endif
+        return true;
+    }
+
+    // ---- iterative teardown ----
+    // A final release that happens while another one is already running on
+    // this thread (a destructor dropping its SharedPtr members) is queued
+    // and run by the outermost release instead of recursing, so tearing down
+    // a long SharedPtr chain uses constant stack.  Queued blocks are run
+    // LIFO, after the destructor that dropped them has returned.
+    struct PendingRelease {
+        void*  cb;
+        void (*del)();                                   // owner's deleter, type-erased
+        void (*run)(void*, void (*)()) noexcept;
+    };
+
+    // Trivially destructible on purpose: SharedPtrs owned by other
+    // thread_locals may still be released after this one "dies".
+    struct ReleaseQueue {
+        bool            active;
+        std::size_t     size, cap;
+        PendingRelease* heap;
+        PendingRelease  local[32];
+
+        PendingRelease* data() noexcept { return heap ? heap : local; }
+        bool push(const PendingRelease& r) noexcept {
+            if(size==(heap ? cap : 32)) {
+                std::size_t n = size * 2;
+                auto* grown = static_cast<PendingRelease*>(std::malloc(n * sizeof(PendingRelease)));
+                if(!grown) return false;
+                std::memcpy(grown, data(), size * sizeof(PendingRelease));
+                std::free(heap); heap = grown; cap = n;
+            }
+            data()[size++] = r;
+            return true;
+        }
     };
+    inline ReleaseQueue& release_queue() noexcept { static thread_local ReleaseQueue q; return q; }
+
+    template<class P>
+    inline void run_pending(void* cb, void (*del)()) noexcept {
+        destroy(static_cast<ControlBlock<P>*>(cb), reinterpret_cast<void (*)(P)>(del));
+    }
+
+    // Drops one reference; the last one destroys the block (see above).
+    template<class P>
+    inline void release(ControlBlock<P>* cb, void (*del)(P)) noexcept {
+#ifdef SHPTR_SAMPLE_CB
+        sample_block(cb, false);
+#endif
+        const ref_value_t left = --cb->ref_cnt;
+#ifdef SHPTR_ATOMIC_WAIT
+        // Waiters hold a reference, so the block outlives them; a notify can
+        // at worst race with a waiter that just left and dropped it.  As in
+        // std::latch implementations, notify_all does not read *cb.
+        if(left & kWaiterMask) cb->ref_cnt.notify_all();
+#endif
+        if((left & kCountMask)!=0) return;
+        ReleaseQueue& q = release_queue();
+        if(q.active) {
+            if(q.push({cb, reinterpret_cast<void (*)()>(del), &run_pending<P>})) return;
+            destroy(cb, del);                            // out of memory: recurse instead
+            return;
+        }
+        q.active = true;
+        destroy(cb, del);
+        while(q.size) { PendingRelease r = q.data()[--q.size]; r.run(r.cb, r.del); }
+        std::free(q.heap); q.heap = nullptr; q.cap = 0;
+        q.active = false;
+    }
+
+#ifdef SHPTR_THREADSAFE
+  #ifdef SHPTR_ATOMIC_WAIT
+    // Counts a waiter in the counter word, so any decrement after that
+    // notifies it.  False when the field is full (or absent, on 32-bit
+    // words): the caller yields instead of carrying into kParked.
+    template<class P>
+    inline bool add_waiter(ControlBlock<P>* cb) noexcept {
+        ref_value_t w = cb->ref_cnt.load(std::memory_order_relaxed);
+        do { if((w & kWaiterMask)==kWaiterMask) return false; }
+        while(!cb->ref_cnt.compare_exchange_weak(w, w + kWaiterOne, std::memory_order_relaxed));
+        return true;
+    }
+  #endif
+
+    // Blocks until at most `n` references remain.  `n` includes the
+    // caller's own reference, so it must be at least 1.
+    template<class P>
+    inline void wait_for_count(ControlBlock<P>* cb, std::size_t n) noexcept {
+        assert(n >= 1 && "wait_until_count(n): n counts the caller's own reference");
+        if(!cb || (word_of(cb->ref_cnt) & kCountMask) <= n) return;
+  #ifdef SHPTR_ATOMIC_WAIT
+        if(add_waiter(cb)) {
+            for(ref_value_t w = word_of(cb->ref_cnt); (w & kCountMask) > n; w = word_of(cb->ref_cnt))
+                cb->ref_cnt.wait(w, std::memory_order_acquire);
+            const ref_value_t before = cb->ref_cnt.fetch_sub(kWaiterOne, std::memory_order_relaxed);
+            assert((before & kWaiterMask)!=0 && "waiter field underflow");
+            (void)before;
+            return;
+        }
+  #endif
+        while((word_of(cb->ref_cnt) & kCountMask) > n) std::this_thread::yield();
+    }
+#endif
+
+    struct SharedPtrAccess;   // lets factories/containers adopt and detach blocks
 }
 
+template<class T> class SharedSpan;     // counted array views, below
+
 // ======================= Primary template (objects) =================
 
 template<class T>
@@ -29,7 +353,9 @@ public:
     //‑‑ ctors ‑‑//
     constexpr SharedPtr() noexcept : cb_(nullptr) {}
     constexpr SharedPtr(std::nullptr_t) noexcept : cb_(nullptr) {}
-    explicit SharedPtr(T* p) : cb_(p ? new detail::ControlBlock<T*>(p) : nullptr) {}
+    explicit SharedPtr(T* p) : cb_(p ? detail::new_block(p, false) : nullptr) {}
+    template<class D>
+    SharedPtr(T* p, D d) : cb_(p ? detail::make_deleter_block(p, d, false) : nullptr) {}   // d(p) on last release
 
     SharedPtr(const SharedPtr& o)  noexcept : cb_(o.cb_) { inc(); }
     SharedPtr(SharedPtr&&  o)  noexcept : cb_(o.cb_) { o.cb_=nullptr; }
@@ -44,28 +370,35 @@ public:
 
     //‑‑ observers ‑‑//
     T* get()                 const noexcept { return cb_?cb_->ptr:nullptr; }
-    std::size_t use_count()  const noexcept { return cb_?cb_->ref_cnt:0; }
+    std::size_t use_count()  const noexcept { return detail::count_of(cb_); }
     bool unique()            const noexcept { return use_count()==1; }
     explicit operator bool() const noexcept { return get()!=nullptr; }
 
+#ifdef SHPTR_THREADSAFE
+    // Block until the other owners are gone (or down to n in total, this
+    // handle included, so n >= 1), e.g. before mutating in place.  Futex
+    // wait with C++20 and a 64-bit counter word, yield loop otherwise.
+    void wait_until_unique() const noexcept { wait_until_count(1); }
+    void wait_until_count(std::size_t n) const noexcept { detail::wait_for_count(cb_, n); }
+#endif
+
     //‑‑ access ‑‑//
     T&  operator*()  const { assert(get()); return *get(); }
     T*  operator->() const noexcept { return get(); }
 
     //‑‑ modifiers ‑‑//
     void reset()      noexcept { dec(delete_object); cb_=nullptr; }
-    void reset(T* p)            { if(get()!=p){ dec(delete_object); cb_=p?new detail::ControlBlock<T*>(p):nullptr; }}
+    void reset(T* p)            { if(get()!=p){ dec(delete_object); cb_=p?detail::new_block(p, false):nullptr; }}
     void swap(SharedPtr& o) noexcept { std::swap(cb_, o.cb_); }
 
 private:
+    friend struct detail::SharedPtrAccess;
     detail::ControlBlock<T*>* cb_;
 
     static void delete_object(T* p){ delete p; }
 
-    void inc() noexcept { if(cb_) ++cb_->ref_cnt; }
-    template<class D> void dec(D del) noexcept {
-        if(!cb_) return; if(--cb_->ref_cnt==0){ del(cb_->ptr); delete cb_; }
-    }
+    void inc() noexcept { if(cb_) detail::retain(cb_); }
+    void dec(void (*del)(T*)) noexcept { if(cb_) detail::release(cb_, del); }
     void assign(const SharedPtr& r) noexcept { if(this==&r) return; dec(delete_object); cb_=r.cb_; inc(); }
     void move_assign(SharedPtr&& r) noexcept { if(this==&r) return; dec(delete_object); cb_=r.cb_; r.cb_=nullptr; }
 };
@@ -77,7 +410,9 @@ class SharedPtr<T[]> {
 public:
     constexpr SharedPtr() noexcept : cb_(nullptr) {}
     constexpr SharedPtr(std::nullptr_t) noexcept : cb_(nullptr) {}
-    explicit SharedPtr(T* p) : cb_(p ? new detail::ControlBlock<T*>(p) : nullptr) {}
+    explicit SharedPtr(T* p) : cb_(p ? detail::new_block(p, true) : nullptr) {}
+    template<class D>
+    SharedPtr(T* p, D d) : cb_(p ? detail::make_deleter_block(p, d, true) : nullptr) {}
 
     SharedPtr(const SharedPtr& o) noexcept : cb_(o.cb_) { inc(); }
     SharedPtr(SharedPtr&&  o) noexcept : cb_(o.cb_) { o.cb_=nullptr; }
@@ -89,30 +424,186 @@ public:
 
     // observers
     T* get()                 const noexcept { return cb_?cb_->ptr:nullptr; }
-    std::size_t use_count()  const noexcept { return cb_?cb_->ref_cnt:0; }
+    std::size_t use_count()  const noexcept { return detail::count_of(cb_); }
     bool unique()            const noexcept { return use_count()==1; }
     explicit operator bool() const noexcept { return get()!=nullptr; }
 
+#ifdef SHPTR_THREADSAFE
+    void wait_until_unique() const noexcept { wait_until_count(1); }
+    void wait_until_count(std::size_t n) const noexcept { detail::wait_for_count(cb_, n); }
+#endif
+
     // element access
     T& operator[](std::size_t i) const { assert(get()); return get()[i]; }
 
+    // Zero-copy view of [offset, offset+len) sharing this block; the block
+    // does not know the array's length, so the range is not checked.  On an
+    // rvalue the reference moves into the view and the count is not touched.
+    SharedSpan<T> slice(std::size_t offset, std::size_t len) const& noexcept;
+    SharedSpan<T> slice(std::size_t offset, std::size_t len) && noexcept;
+
     // modifiers
     void reset()      noexcept { dec(delete_array); cb_=nullptr; }
-    void reset(T* p)            { if(get()!=p){ dec(delete_array); cb_=p?new detail::ControlBlock<T*>(p):nullptr; }}
+    void reset(T* p)            { if(get()!=p){ dec(delete_array); cb_=p?detail::new_block(p, true):nullptr; }}
     void swap(SharedPtr& o) noexcept { std::swap(cb_, o.cb_); }
 
 private:
+    friend struct detail::SharedPtrAccess;
     detail::ControlBlock<T*>* cb_;
     static void delete_array(T* p){ delete[] p; }
-    void inc() noexcept { if(cb_) ++cb_->ref_cnt; }
-    template<class D> void dec(D del) noexcept { if(!cb_) return; if(--cb_->ref_cnt==0){ del(cb_->ptr); delete cb_; }}
+    void inc() noexcept { if(cb_) detail::retain(cb_); }
+    void dec(void (*del)(T*)) noexcept { if(cb_) detail::release(cb_, del); }
     void assign(const SharedPtr& r) noexcept { if(this==&r) return; dec(delete_array); cb_=r.cb_; inc(); }
     void move_assign(SharedPtr&& r) noexcept { if(this==&r) return; dec(delete_array); cb_=r.cb_; r.cb_=nullptr; }
 };
 
+// ========================= Control-block access =======================
+// Used by pools, queues and factories that build or move blocks themselves.
+// adopt() takes over one existing reference; detach() hands one out.
+
+namespace detail {
+    struct SharedPtrAccess {
+        template<class S> static auto* block(const S& s) noexcept { return s.cb_; }
+        template<class S> static auto* detach(S& s) noexcept { auto* cb=s.cb_; s.cb_=nullptr; return cb; }
+        template<class S, class CB> static S adopt(CB* cb) noexcept { S s; s.cb_=cb; return s; }
+    };
+}
+
+// ======================= allocate_shared_ptr<T> ======================
+// One allocation from `alloc` holds the control block, the allocator copy
+// (free when stateless) and the object; the last release destroys the
+// object and gives the block back to the same allocator.
+
+namespace detail {
+    template<class T, class A>
+    struct AllocBlock : HookedBlock<T*>, EboHolder<A> {
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        explicit AllocBlock(const A& a) : HookedBlock<T*>(object_of(storage), &dispose), EboHolder<A>(a) {}
+        static T* object_of(unsigned char* s) noexcept { return reinterpret_cast<T*>(s); }
+        static void dispose(ControlBlock<T*>* cb) noexcept {
+            auto* b = static_cast<AllocBlock*>(cb);
+            using BA = typename std::allocator_traits<A>::template rebind_alloc<AllocBlock>;
+            std::allocator_traits<A>::destroy(b->get(), cb->ptr);
+            BA ba(b->get());
+            b->~AllocBlock();
+            std::allocator_traits<BA>::deallocate(ba, b, 1);
+        }
+    };
+}
+
+template<class T, class A, class... Args>
+SharedPtr<T> allocate_shared_ptr(const A& alloc, Args&&... args) {
+    using TA     = typename std::allocator_traits<A>::template rebind_alloc<T>;
+    using Block  = detail::AllocBlock<T, TA>;
+    using BA     = typename std::allocator_traits<A>::template rebind_alloc<Block>;
+    using Traits = std::allocator_traits<BA>;
+    BA ba(alloc);
+    Block* b = Traits::allocate(ba, 1);
+    try { ::new (static_cast<void*>(b)) Block(TA(alloc)); } catch(...) { Traits::deallocate(ba, b, 1); throw; }
+    try { std::allocator_traits<TA>::construct(b->get(), Block::object_of(b->storage), std::forward<Args>(args)...); }
+    catch(...) { b->~Block(); Traits::deallocate(ba, b, 1); throw; }
+    return detail::SharedPtrAccess::adopt<SharedPtr<T>>(detail::accounted<T>(b, false, 0, sizeof(Block) - sizeof(T)));
+}
+
+// Value-initialised array of n elements.  Unlike SharedPtr<T[]>(new T[n]),
+// the length is known, so memory accounting can attribute the bytes.
+template<class T>
+SharedPtr<T[]> make_shared_array(std::size_t n) {
+    if(n==0) return SharedPtr<T[]>();
+    T* p = new T[n]();
+    detail::ControlBlock<T*>* cb;
+    try { cb = new detail::ControlBlock<T*>(p); } catch(...) { delete[] p; throw; }
+    return detail::SharedPtrAccess::adopt<SharedPtr<T[]>>(detail::accounted<T>(cb, true, n));
+}
+
+// ========================= layout guarantees =========================
+// 64-bit targets: plain blocks stay at two words; hooks add one; a
+// stateless deleter or allocator adds nothing.  (SHPTR_ACCOUNTING adds
+// a word to every block.)
+#ifndef SHPTR_ACCOUNTING
+
+static_assert(sizeof(void*)!=8 || sizeof(detail::ControlBlock<int*>)==16, "plain control block must be two words");
+static_assert(sizeof(void*)!=8 || sizeof(detail::HookedBlock<int*>)==24, "hooked control block must be three words");
+static_assert(sizeof(detail::DeleterBlock<int*, std::default_delete<int>>)==sizeof(detail::HookedBlock<int*>),
+              "a stateless deleter must not grow the block");
+#endif
+
+// ========================= SharedSpan (array views) ===================
+// A counted view [data(), data()+size()) into an array owned by a
+// SharedPtr<T[]>.  It shares the parent's control block, so a view keeps
+// the whole array alive without copying or allocating anything.
+
+template<class T>
+class SharedSpan {
+public:
+    constexpr SharedSpan() noexcept : cb_(nullptr), ptr_(nullptr), len_(0) {}
+    SharedSpan(const SharedPtr<T[]>& owner, std::size_t offset, std::size_t len) noexcept
+        : cb_(detail::SharedPtrAccess::block(owner)), ptr_(cb_ ? cb_->ptr + offset : nullptr), len_(len) { assert(owner || (offset==0 && len==0)); inc(); }
+    SharedSpan(SharedPtr<T[]>&& owner, std::size_t offset, std::size_t len) noexcept
+        : cb_(detail::SharedPtrAccess::detach(owner)), ptr_(cb_ ? cb_->ptr + offset : nullptr), len_(len) { assert(cb_ || (offset==0 && len==0)); }
+
+    SharedSpan(const SharedSpan& o) noexcept : cb_(o.cb_), ptr_(o.ptr_), len_(o.len_) { inc(); }
+    SharedSpan(SharedSpan&& o) noexcept : cb_(o.cb_), ptr_(o.ptr_), len_(o.len_) { o.cb_=nullptr; o.ptr_=nullptr; o.len_=0; }
+    ~SharedSpan() { dec(); }
+
+    SharedSpan& operator=(const SharedSpan& r) noexcept { SharedSpan(r).swap(*this); return *this; }
+    SharedSpan& operator=(SharedSpan&& r) noexcept { SharedSpan(std::move(r)).swap(*this); return *this; }
+
+    // observers
+    T*          data()       const noexcept { return ptr_; }
+    std::size_t size()       const noexcept { return len_; }
+    bool        empty()      const noexcept { return len_==0; }
+    std::size_t use_count()  const noexcept { return detail::count_of(cb_); }
+    T* begin()               const noexcept { return ptr_; }
+    T* end()                 const noexcept { return ptr_ + len_; }
+    T& operator[](std::size_t i) const { assert(i<len_); return ptr_[i]; }
+
+    // zero-copy sub-view sharing the same control block; an rvalue hands
+    // its reference over instead of taking another
+    SharedSpan subspan(std::size_t offset, std::size_t len) const& noexcept {
+        assert(offset<=len_ && len<=len_-offset);
+        SharedSpan s(*this); s.ptr_ += offset; s.len_ = len;
+        return s;
+    }
+    SharedSpan subspan(std::size_t offset, std::size_t len) && noexcept {
+        assert(offset<=len_ && len<=len_-offset);
+        SharedSpan s(std::move(*this)); s.ptr_ += offset; s.len_ = len;
+        return s;
+    }
+
+    void reset() noexcept { dec(); cb_=nullptr; ptr_=nullptr; len_=0; }
+    void swap(SharedSpan& o) noexcept { std::swap(cb_, o.cb_); std::swap(ptr_, o.ptr_); std::swap(len_, o.len_); }
+
+private:
+    detail::ControlBlock<T*>* cb_;
+    T*                        ptr_;
+    std::size_t               len_;
+
+    static void delete_array(T* p){ delete[] p; }
+    void inc() noexcept { if(cb_) detail::retain(cb_); }
+    void dec() noexcept { if(cb_) detail::release(cb_, delete_array); }
+};
+
+template<class T>
+SharedSpan<T> SharedPtr<T[]>::slice(std::size_t offset, std::size_t len) const& noexcept { return SharedSpan<T>(*this, offset, len); }
+template<class T>
+SharedSpan<T> SharedPtr<T[]>::slice(std::size_t offset, std::size_t len) && noexcept { return SharedSpan<T>(std::move(*this), offset, len); }
+
 // =========================== free swap (ADL) =========================
 
 template<class T> inline void swap(SharedPtr<T>& a, SharedPtr<T>& b) noexcept { a.swap(b); }
 template<class T> inline void swap(SharedPtr<T[]>& a, SharedPtr<T[]>& b) noexcept { a.swap(b); }
+template<class T> inline void swap(SharedSpan<T>& a, SharedSpan<T>& b) noexcept { a.swap(b); }
+
+#ifdef SHPTR_RELEASE_TIMING
+  #include "ReleaseHistogram.h"
+#endif
+#ifdef SHPTR_SAMPLE_CB
+  #include "HotBlockSampler.h"
+#endif
+#ifdef SHPTR_ACCOUNTING
+  #include "MemoryAccounting.h"
+#endif
 
 #endif // SHARED_PTR_H
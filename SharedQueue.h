@@ -0,0 +1,92 @@
+#ifndef SHARED_QUEUE_H
+#define SHARED_QUEUE_H
+
+#include <atomic>
+#include <cstddef>      // std::size_t
+#include <limits>       // std::numeric_limits
+#include <memory>       // std::unique_ptr
+#include <stdexcept>    // std::length_error
+#include <type_traits>  // std::remove_pointer_t
+#include <utility>      // std::declval
+#include "SharedPtr.h"
+
+// =========================== SharedQueue =============================
+// Bounded lock-free MPMC ring (Vyukov's sequence-numbered cells) for
+// SharedPtr<T> / SharedPtr<T[]>.  Slots hold raw control blocks: push
+// detaches the caller's reference and pop adopts it, so a push/pop pair
+// performs no reference-count operations at all.
+
+template<class S>
+class SharedQueue {
+    using Block = std::remove_pointer_t<decltype(detail::SharedPtrAccess::block(std::declval<const S&>()))>;
+
+    struct Cell {
+        std::atomic<std::size_t> seq;
+        Block*                   cb;
+    };
+    static constexpr std::size_t kLine = 64;
+
+public:
+    // capacity is rounded up to a power of two (minimum 2); std::length_error
+    // if that would not fit in a size_t
+    explicit SharedQueue(std::size_t capacity) : mask_(round_up(capacity) - 1), cells_(new Cell[mask_ + 1]) {
+        for(std::size_t i = 0; i <= mask_; ++i) { cells_[i].seq.store(i, std::memory_order_relaxed); cells_[i].cb = nullptr; }
+    }
+    SharedQueue(const SharedQueue&) = delete;
+    SharedQueue& operator=(const SharedQueue&) = delete;
+    ~SharedQueue() { S drop; while(try_pop(drop)) drop.reset(); }
+
+    // Moves `p` into the queue; on failure (queue full) `p` is left untouched.
+    bool try_push(S& p) noexcept {
+        Cell* c; std::size_t pos = tail_.load(std::memory_order_relaxed);
+        for(;;) {
+            c = &cells_[pos & mask_];
+            std::size_t seq = c->seq.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if(diff==0) { if(tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break; }
+            else if(diff<0) return false;
+            else pos = tail_.load(std::memory_order_relaxed);
+        }
+        c->cb = detail::SharedPtrAccess::detach(p);
+        c->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+    bool try_push(S&& p) noexcept { return try_push(p); }
+
+    // Moves the oldest element into `out` (whose previous value is released).
+    bool try_pop(S& out) noexcept {
+        Cell* c; std::size_t pos = head_.load(std::memory_order_relaxed);
+        for(;;) {
+            c = &cells_[pos & mask_];
+            std::size_t seq = c->seq.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if(diff==0) { if(head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break; }
+            else if(diff<0) return false;
+            else pos = head_.load(std::memory_order_relaxed);
+        }
+        Block* cb = c->cb;
+        c->seq.store(pos + mask_ + 1, std::memory_order_release);
+        out = detail::SharedPtrAccess::adopt<S>(cb);
+        return true;
+    }
+
+    std::size_t capacity() const noexcept { return mask_ + 1; }
+    // approximate under concurrency
+    std::size_t size() const noexcept {
+        std::size_t t = tail_.load(std::memory_order_relaxed), h = head_.load(std::memory_order_relaxed);
+        return t > h ? t - h : 0;
+    }
+
+private:
+    static std::size_t round_up(std::size_t n) {
+        if(n > std::numeric_limits<std::size_t>::max() / 2 + 1) throw std::length_error("SharedQueue: capacity too large");
+        std::size_t c = 2; while(c < n) c <<= 1; return c;
+    }
+
+    const std::size_t                       mask_;
+    std::unique_ptr<Cell[]>                 cells_;
+    alignas(kLine) std::atomic<std::size_t> tail_{0};
+    alignas(kLine) std::atomic<std::size_t> head_{0};
+};
+
+#endif // SHARED_QUEUE_H
@@ -0,0 +1,402 @@
+#ifndef SHM_SHARED_PTR_H
+#define SHM_SHARED_PTR_H
+
+#ifndef __linux__
+  #error "ShmSharedPtr.h needs Linux (shm_open, robust process-shared mutexes)"
+#endif
+
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <chrono>         // std::chrono::milliseconds
+#include <cstddef>        // std::size_t
+#include <cstdint>        // std::uint64_t, std::uint32_t
+#include <memory>         // std::unique_ptr
+#include <new>            // std::bad_alloc, std::nothrow, placement new
+#include <stdexcept>      // std::runtime_error
+#include <string>
+#include <system_error>   // std::system_error
+#include <thread>         // std::this_thread::sleep_for
+#include <type_traits>
+#include <utility>        // std::exchange, std::forward, std::swap
+#include <fcntl.h>        // O_* flags
+#include <pthread.h>
+#include <signal.h>       // ::kill
+#include <sys/mman.h>     // ::shm_open, ::mmap
+#include <sys/stat.h>     // ::fstat
+#include <unistd.h>       // ::ftruncate, ::getpid
+
+// ====================== ShmSharedPtr (Linux only) ====================
+// Reference-counted objects in a POSIX shared-memory segment that several
+// processes map at different addresses.  Everything inside the segment is
+// addressed by offset; a ShmSharedPtr<T> is a process-local handle
+// {segment, offset} and its ref_cnt is an address-free atomic in the
+// segment, so handles in different processes share one count.
+//
+// Crash safety: each process attached to the segment owns a slot, and
+// every block records how many of its references each slot holds.  reap()
+// (also run whenever a process attaches) finds slots whose pid is gone,
+// returns their references and frees what that leaves unowned.  Counter
+// updates are ordered so that dying half-way can only leak a reference,
+// never free a live object.  PID reuse is not detected.
+//
+// Objects must be trivially destructible: the reaper, which does not know
+// their type, may be the one that frees them.  Cross-process sharing goes
+// through the segment's root slots: publish() / lookup().
+//
+// A handle keeps a plain pointer to its ShmSegment.  Release every handle
+// before destroying the segment: the destructor returns this process's
+// references and unmaps the memory, so a later release would touch freed
+// memory.  Debug builds count the handles and assert on that.
+//
+// Releases and the destructor never throw.  If the robust mutex cannot be
+// taken there, the block is leaked, or the slot is left for reap(), rather
+// than terminating the process.  A process that dies holding the mutex
+// makes the next locker check the heap and free list and reap the dead
+// slot.  If the check fails, the segment is poisoned: every later
+// operation that locks throws, and releases leak.
+
+class ShmSegment;
+
+namespace detail {
+    constexpr unsigned      kShmMaxProcs = 64;
+    constexpr unsigned      kShmRoots    = 16;
+    constexpr std::size_t   kShmAlign    = 64;
+    constexpr std::uint64_t kShmMagic    = 0x53484d5054523031ull;   // "SHMPTR01"
+
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "shared-memory counters must be address-free");
+
+    struct ShmBlock {
+        std::atomic<std::uint64_t> ref_cnt;
+        std::uint64_t              bytes;       // payload capacity
+        std::uint64_t              count;       // elements
+        std::uint64_t              next_free;   // free-list link (block offset), 0 = end
+        std::uint32_t              live;
+        std::atomic<std::uint32_t> held[kShmMaxProcs];   // references per process slot
+    };
+    constexpr std::size_t kShmBlockHeader = (sizeof(ShmBlock) + kShmAlign - 1) / kShmAlign * kShmAlign;
+
+    struct ShmHeader {
+        std::atomic<std::uint64_t> magic;       // set last: segment is initialised
+        std::uint64_t              size;
+        pthread_mutex_t            lock;        // robust + process-shared: allocator, slots, roots
+        std::uint64_t              heap_begin, bump, free_head;
+        std::atomic<std::int32_t>  pids[kShmMaxProcs];   // 0 = free slot
+        std::uint64_t              roots[kShmRoots];     // block offsets, segment-owned refs
+    };
+
+    inline bool pid_alive(std::int32_t pid) noexcept { return ::kill(pid, 0)==0 || errno==EPERM; }
+    [[noreturn]] inline void shm_fail(const char* what) { throw std::system_error(errno, std::generic_category(), what); }
+}
+
+template<class T>
+class ShmSharedPtr {
+    static_assert(std::is_trivially_destructible<T>::value, "ShmSharedPtr<T>: T must be trivially destructible");
+public:
+    constexpr ShmSharedPtr() noexcept : seg_(nullptr), off_(0) {}
+    ShmSharedPtr(const ShmSharedPtr& o) noexcept : seg_(o.seg_), off_(o.off_) { inc(); }
+    ShmSharedPtr(ShmSharedPtr&& o) noexcept : seg_(o.seg_), off_(o.off_) { o.seg_=nullptr; o.off_=0; }
+    ~ShmSharedPtr() { dec(); }
+
+    ShmSharedPtr& operator=(const ShmSharedPtr& r) noexcept { ShmSharedPtr(r).swap(*this); return *this; }
+    ShmSharedPtr& operator=(ShmSharedPtr&& r) noexcept { ShmSharedPtr(std::move(r)).swap(*this); return *this; }
+
+    //‑‑ observers ‑‑//
+    inline T*    get()       const noexcept;
+    std::size_t  size()      const noexcept { return off_ ? block()->count : 0; }
+    std::size_t  use_count() const noexcept { return off_ ? block()->ref_cnt.load(std::memory_order_acquire) : 0; }
+    std::uint64_t offset()   const noexcept { return off_; }
+    explicit operator bool() const noexcept { return off_!=0; }
+
+    //‑‑ access ‑‑//
+    T& operator*()  const { assert(off_); return *get(); }
+    T* operator->() const noexcept { return get(); }
+    T& operator[](std::size_t i) const { assert(i<size()); return get()[i]; }
+
+    //‑‑ modifiers ‑‑//
+    void reset() noexcept { dec(); seg_=nullptr; off_=0; }
+    void swap(ShmSharedPtr& o) noexcept { std::swap(seg_, o.seg_); std::swap(off_, o.off_); }
+
+private:
+    friend class ShmSegment;
+    ShmSegment*   seg_;
+    std::uint64_t off_;    // block offset within the segment
+
+    ShmSharedPtr(ShmSegment* s, std::uint64_t off) noexcept : seg_(s), off_(off) {}   // adopts one reference
+    inline detail::ShmBlock* block() const noexcept;
+    inline void inc() noexcept;
+    inline void dec() noexcept;
+};
+
+class ShmSegment {
+public:
+    using Header = detail::ShmHeader;
+    using Block  = detail::ShmBlock;
+
+    // Creates a new segment of `bytes` (fails if the name exists).  If
+    // anything after shm_open throws, the name is unlinked again, so a
+    // retry is not refused with EEXIST.
+    static std::unique_ptr<ShmSegment> create(const std::string& name, std::size_t bytes) {
+        int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if(fd<0) detail::shm_fail("ShmSegment::create: shm_open");
+        try {
+            if(::ftruncate(fd, static_cast<off_t>(bytes))!=0) { int e=errno; ::close(fd); fd=-1; errno=e; detail::shm_fail("ShmSegment::create: ftruncate"); }
+            std::unique_ptr<ShmSegment> s(new ShmSegment(std::exchange(fd, -1), bytes));   // closes fd
+            s->init();
+            s->attach();
+            return s;
+        } catch(...) {
+            int e = errno;
+            if(fd>=0) ::close(fd);
+            ::shm_unlink(name.c_str());
+            errno = e;
+            throw;
+        }
+    }
+    // Attaches to an existing segment created by another process.
+    static std::unique_ptr<ShmSegment> open(const std::string& name) {
+        int fd = ::shm_open(name.c_str(), O_RDWR, 0600);
+        if(fd<0) detail::shm_fail("ShmSegment::open: shm_open");
+        struct stat st;
+        if(::fstat(fd, &st)!=0) { int e=errno; ::close(fd); errno=e; detail::shm_fail("ShmSegment::open: fstat"); }
+        std::unique_ptr<ShmSegment> s(new ShmSegment(fd, static_cast<std::size_t>(st.st_size)));
+        for(int i = 0; s->hdr_->magic.load(std::memory_order_acquire)!=detail::kShmMagic; ++i) {
+            if(i==1000) throw std::runtime_error("ShmSegment::open: segment never initialised");
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        s->attach();
+        return s;
+    }
+    static void unlink(const std::string& name) noexcept { ::shm_unlink(name.c_str()); }
+
+    ShmSegment(const ShmSegment&) = delete;
+    ShmSegment& operator=(const ShmSegment&) = delete;
+    // Detaching returns every reference this process still holds.
+    ~ShmSegment() {
+        assert(handles_.load(std::memory_order_relaxed)==0 && "ShmSharedPtr handles must not outlive their ShmSegment");
+        if(slot_>=0) { Lock g(this, std::nothrow); if(g) release_slot(static_cast<unsigned>(slot_)); }   // else reaped after exit
+        ::munmap(hdr_, size_);
+    }
+
+    //‑‑ allocation ‑‑//
+    template<class T, class... A>
+    ShmSharedPtr<T> make(A&&... args) {
+        std::uint64_t off = allocate(sizeof(T), 1, alignof(T));
+        ::new (payload(off)) T(std::forward<A>(args)...);
+        return ShmSharedPtr<T>(this, off);
+    }
+    template<class T>
+    ShmSharedPtr<T> make_array(std::size_t n) {
+        std::uint64_t off = allocate(sizeof(T) * n, n, alignof(T));
+        ::new (payload(off)) T[n]();
+        return ShmSharedPtr<T>(this, off);
+    }
+
+    //‑‑ cross-process handoff through root slots ‑‑//
+    template<class T>
+    void publish(unsigned root, const ShmSharedPtr<T>& p) {
+        assert(root<detail::kShmRoots && (!p || p.seg_==this));
+        Lock g(this);
+        if(p) at(p.off_)->ref_cnt.fetch_add(1, std::memory_order_relaxed);
+        std::uint64_t old = std::exchange(hdr_->roots[root], p.off_);
+        if(old && at(old)->ref_cnt.fetch_sub(1, std::memory_order_acq_rel)==1) free_block(old);
+    }
+    void unpublish(unsigned root) { publish(root, ShmSharedPtr<char>()); }
+
+    template<class T>
+    ShmSharedPtr<T> lookup(unsigned root) {
+        assert(root<detail::kShmRoots);
+        Lock g(this);
+        std::uint64_t off = hdr_->roots[root];
+        if(!off) return ShmSharedPtr<T>();
+        take(at(off));
+        return ShmSharedPtr<T>(this, off);
+    }
+
+    // Returns the references of dead processes; yields the number reaped.
+    std::size_t reap() { Lock g(this); return reap_locked(); }
+
+    unsigned    slot()  const noexcept { return static_cast<unsigned>(slot_); }
+    std::size_t size()  const noexcept { return size_; }
+    void*       base()  const noexcept { return hdr_; }
+
+private:
+    template<class T> friend class ShmSharedPtr;
+
+    Header* hdr_;
+    std::size_t size_;
+    int slot_ = -1;
+#ifndef NDEBUG
+    std::atomic<std::size_t> handles_{0};           // references held through handles
+#endif
+
+    // The segment's robust mutex.  If the previous holder died inside a
+    // critical section, the segment is checked and repaired (recover_locked)
+    // before the mutex is marked consistent.  If the check fails, the mutex
+    // is left unrecoverable: every later lock, in every process, fails with
+    // ENOTRECOVERABLE rather than reusing a corrupt allocator.
+    struct Lock {
+        pthread_mutex_t* m;
+        explicit Lock(ShmSegment* s) : m(&s->hdr_->lock) {
+            if(int r = acquire(s)) {
+                errno = r;
+                detail::shm_fail(r==ENOTRECOVERABLE ? "ShmSegment: segment poisoned by a process that died holding its lock"
+                                                    : "ShmSegment: lock");
+            }
+        }
+        // For noexcept paths: holds nothing (false) if the lock failed.
+        Lock(ShmSegment* s, std::nothrow_t) noexcept : m(&s->hdr_->lock) { if(acquire(s)) m = nullptr; }
+        ~Lock() { if(m) pthread_mutex_unlock(m); }
+        Lock(const Lock&) = delete;
+        Lock& operator=(const Lock&) = delete;
+        explicit operator bool() const noexcept { return m!=nullptr; }
+
+        static int acquire(ShmSegment* s) noexcept {
+            pthread_mutex_t* m = &s->hdr_->lock;
+            int r = pthread_mutex_lock(m);
+            if(r==EOWNERDEAD) {                     // previous holder died
+                if(s->recover_locked()) { pthread_mutex_consistent(m); r = 0; }
+                else                    { pthread_mutex_unlock(m); r = ENOTRECOVERABLE; }
+            }
+            return r;
+        }
+    };
+
+    ShmSegment(int fd, std::size_t bytes) : size_(bytes) {
+        void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        int e = errno;
+        ::close(fd);
+        if(p==MAP_FAILED) { errno = e; detail::shm_fail("ShmSegment: mmap"); }
+        hdr_ = static_cast<Header*>(p);
+    }
+
+    void init() {
+        if(size_ < sizeof(Header) + detail::kShmBlockHeader) throw std::invalid_argument("ShmSegment::create: segment too small");
+        pthread_mutexattr_t a;
+        pthread_mutexattr_init(&a);
+        pthread_mutexattr_setpshared(&a, PTHREAD_PROCESS_SHARED);
+        pthread_mutexattr_setrobust(&a, PTHREAD_MUTEX_ROBUST);
+        pthread_mutex_init(&hdr_->lock, &a);
+        pthread_mutexattr_destroy(&a);
+        hdr_->size       = size_;
+        hdr_->heap_begin = (sizeof(Header) + detail::kShmAlign - 1) / detail::kShmAlign * detail::kShmAlign;
+        hdr_->bump       = hdr_->heap_begin;
+        hdr_->free_head  = 0;
+        for(auto& p : hdr_->pids) p.store(0, std::memory_order_relaxed);
+        for(auto& r : hdr_->roots) r = 0;
+        hdr_->magic.store(detail::kShmMagic, std::memory_order_release);
+    }
+
+    void attach() {
+        Lock g(this);
+        reap_locked();
+        for(unsigned i = 0; i < detail::kShmMaxProcs; ++i)
+            if(hdr_->pids[i].load(std::memory_order_relaxed)==0) {
+                hdr_->pids[i].store(static_cast<std::int32_t>(::getpid()), std::memory_order_relaxed);
+                slot_ = static_cast<int>(i);
+                return;
+            }
+        throw std::runtime_error("ShmSegment: all process slots are in use");
+    }
+
+    Block* at(std::uint64_t off) const noexcept { return reinterpret_cast<Block*>(reinterpret_cast<char*>(hdr_) + off); }
+    void*  payload(std::uint64_t off) const noexcept { return reinterpret_cast<char*>(hdr_) + off + detail::kShmBlockHeader; }
+
+    // One new reference for this process: global count first, then the
+    // per-slot tally, so a crash in between can only leak.
+    void take(Block* b) noexcept {
+        b->ref_cnt.fetch_add(1, std::memory_order_relaxed);
+        b->held[slot_].fetch_add(1, std::memory_order_relaxed);
+#ifndef NDEBUG
+        handles_.fetch_add(1, std::memory_order_relaxed);
+#endif
+    }
+    void drop(std::uint64_t off) noexcept {
+        Block* b = at(off);
+#ifndef NDEBUG
+        handles_.fetch_sub(1, std::memory_order_relaxed);
+#endif
+        b->held[slot_].fetch_sub(1, std::memory_order_relaxed);
+        if(b->ref_cnt.fetch_sub(1, std::memory_order_acq_rel)==1) {
+            Lock g(this, std::nothrow);
+            if(g) free_block(off);                  // else the block leaks: better than throwing here
+        }
+    }
+
+    std::uint64_t allocate(std::size_t bytes, std::size_t count, std::size_t align) {
+        if(align > detail::kShmAlign) throw std::invalid_argument("ShmSegment: over-aligned type");
+        std::uint64_t need = (bytes + detail::kShmAlign - 1) / detail::kShmAlign * detail::kShmAlign;
+        Lock g(this);
+        std::uint64_t off = 0;
+        for(std::uint64_t* link = &hdr_->free_head; *link; link = &at(*link)->next_free)   // first fit
+            if(at(*link)->bytes >= need) { off = *link; *link = at(off)->next_free; break; }
+        if(!off) {
+            if(hdr_->bump + detail::kShmBlockHeader + need > hdr_->size) throw std::bad_alloc();
+            off = hdr_->bump;
+            at(off)->bytes = need;                  // before bump: the heap stays walkable
+            std::atomic_signal_fence(std::memory_order_release);
+            hdr_->bump += detail::kShmBlockHeader + need;
+        }
+        Block* b = at(off);
+        b->count = count; b->next_free = 0; b->live = 1;
+        for(auto& h : b->held) h.store(0, std::memory_order_relaxed);
+        b->ref_cnt.store(0, std::memory_order_relaxed);
+        take(b);
+        return off;
+    }
+    void free_block(std::uint64_t off) noexcept {   // lock held
+        Block* b = at(off);
+        b->live = 0;
+        b->next_free = hdr_->free_head;
+        hdr_->free_head = off;
+    }
+
+    void release_slot(unsigned s) noexcept {        // lock held
+        for(std::uint64_t off = hdr_->heap_begin; off < hdr_->bump; off += detail::kShmBlockHeader + at(off)->bytes) {
+            Block* b = at(off);
+            if(!b->live) continue;
+            std::uint32_t n = b->held[s].exchange(0, std::memory_order_relaxed);
+            if(n && b->ref_cnt.fetch_sub(n, std::memory_order_acq_rel)==n) free_block(off);
+        }
+        hdr_->pids[s].store(0, std::memory_order_relaxed);
+    }
+    // Called with the lock just taken from a holder that died.  A crash
+    // inside a critical section can only leak blocks or references, so
+    // if the heap and the free list still check out, the dead process's
+    // references are returned (reap) and the segment is usable.  A heap
+    // walk that runs off its end, or a free list that leaves the heap, hits
+    // a live block or loops, means a store was lost: false.
+    bool recover_locked() noexcept {
+        const std::uint64_t begin = hdr_->heap_begin, end = hdr_->bump;
+        if(begin % detail::kShmAlign || end < begin || end > hdr_->size) return false;
+        std::uint64_t blocks = 0;
+        for(std::uint64_t off = begin; off < end; off += detail::kShmBlockHeader + at(off)->bytes, ++blocks) {
+            if(end - off < detail::kShmBlockHeader) return false;
+            const Block* b = at(off);
+            if(b->bytes % detail::kShmAlign || b->bytes > end - off - detail::kShmBlockHeader || b->live > 1) return false;
+        }
+        std::uint64_t n = 0;
+        for(std::uint64_t off = hdr_->free_head; off; off = at(off)->next_free)
+            if(++n > blocks || off < begin || off >= end || (off - begin) % detail::kShmAlign || at(off)->live) return false;
+        reap_locked();
+        return true;
+    }
+
+    std::size_t reap_locked() noexcept {
+        std::size_t reaped = 0;
+        for(unsigned s = 0; s < detail::kShmMaxProcs; ++s) {
+            std::int32_t pid = hdr_->pids[s].load(std::memory_order_relaxed);
+            if(pid && static_cast<int>(s)!=slot_ && !detail::pid_alive(pid)) { release_slot(s); ++reaped; }
+        }
+        return reaped;
+    }
+};
+
+template<class T> inline detail::ShmBlock* ShmSharedPtr<T>::block() const noexcept { return seg_->at(off_); }
+template<class T> inline T* ShmSharedPtr<T>::get() const noexcept { return off_ ? static_cast<T*>(seg_->payload(off_)) : nullptr; }
+template<class T> inline void ShmSharedPtr<T>::inc() noexcept { if(off_) seg_->take(block()); }
+template<class T> inline void ShmSharedPtr<T>::dec() noexcept { if(off_) seg_->drop(off_); }
+
+template<class T> inline void swap(ShmSharedPtr<T>& a, ShmSharedPtr<T>& b) noexcept { a.swap(b); }
+
+#endif // SHM_SHARED_PTR_H
@@ -0,0 +1,36 @@
+#ifndef TYPE_NAME_H
+#define TYPE_NAME_H
+
+#include <string>
+#include <typeinfo>
+#if defined(__GNUG__)
+  #include <cxxabi.h>   // abi::__cxa_demangle
+  #include <cstdlib>    // std::free
+#endif
+
+// ============================ type names =============================
+// Readable name of T for the diagnostic reports (release timing, hot
+// blocks, memory accounting): demangled where the ABI allows, the
+// size only without RTTI.
+
+namespace detail {
+    template<class T>
+    std::string type_name() {
+#if defined(__GXX_RTTI) || defined(_CPPRTTI) || defined(__cpp_rtti)
+        const char* raw = typeid(T).name();
+  #if defined(__GNUG__)
+        int status = 0;
+        char* pretty = abi::__cxa_demangle(raw, nullptr, nullptr, &status);
+        std::string name = status==0 && pretty ? pretty : raw;
+        std::free(pretty);
+        return name;
+  #else
+        return raw;
+  #endif
+#else
+        return "type of size " + std::to_string(sizeof(T));
+#endif
+    }
+}
+
+#endif // TYPE_NAME_H
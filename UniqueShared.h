@@ -0,0 +1,78 @@
+#ifndef UNIQUE_SHARED_H
+#define UNIQUE_SHARED_H
+
+#include <cstddef>      // std::nullptr_t
+#include <new>          // placement new
+#include <utility>      // std::forward, std::exchange
+#include "SharedPtr.h"
+
+// =========================== UniqueShared ============================
+// Sole-owner pointer allocated together with a dormant control block.
+// While unique it never touches the counter (destruction goes straight to
+// the block's dispose hook); share() turns it into a SharedPtr<T> in place,
+// with no allocation and no counter update — the block starts at 1.
+
+namespace detail {
+    template<class T>
+    struct InlineBlock : HookedBlock<T*> {
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        InlineBlock() noexcept : HookedBlock<T*>(reinterpret_cast<T*>(storage), &dispose) {}
+        static void dispose(ControlBlock<T*>* cb) noexcept {
+            cb->ptr->~T();
+            delete static_cast<InlineBlock*>(cb);
+        }
+    };
+}
+
+template<class T>
+class UniqueShared {
+    using Block = detail::InlineBlock<T>;
+public:
+    constexpr UniqueShared() noexcept : blk_(nullptr) {}
+    constexpr UniqueShared(std::nullptr_t) noexcept : blk_(nullptr) {}
+
+    UniqueShared(const UniqueShared&) = delete;
+    UniqueShared(UniqueShared&& o) noexcept : blk_(std::exchange(o.blk_, nullptr)) {}
+    UniqueShared& operator=(const UniqueShared&) = delete;
+    UniqueShared& operator=(UniqueShared&& r) noexcept { if(this!=&r){ reset(); blk_=std::exchange(r.blk_, nullptr); } return *this; }
+    ~UniqueShared() { reset(); }
+
+    template<class... A>
+    static UniqueShared make(A&&... args) {
+        UniqueShared u; u.blk_ = new Block;
+        try { ::new (static_cast<void*>(u.blk_->storage)) T(std::forward<A>(args)...); }
+        catch(...) { delete u.blk_; u.blk_ = nullptr; throw; }
+        detail::accounted<T>(u.blk_, false, 0, sizeof(Block) - sizeof(T));
+        return u;
+    }
+
+    //‑‑ observers ‑‑//
+    T* get()                 const noexcept { return blk_?blk_->ptr:nullptr; }
+    explicit operator bool() const noexcept { return blk_!=nullptr; }
+    T& operator*()           const { assert(get()); return *get(); }
+    T* operator->()          const noexcept { return get(); }
+
+    //‑‑ modifiers ‑‑//
+    void reset() noexcept {
+        if(!blk_) return;
+#ifdef SHPTR_ACCOUNTING
+        detail::account_delete(blk_->acct);      // destroy() does this for shared blocks
+#endif
+        Block::dispose(blk_); blk_=nullptr;
+    }
+
+    // Promotion: hands the dormant block (count already 1) to a SharedPtr.
+    SharedPtr<T> share() && noexcept {
+        return detail::SharedPtrAccess::adopt<SharedPtr<T>>(std::exchange(blk_, nullptr));
+    }
+    operator SharedPtr<T>() && noexcept { return std::move(*this).share(); }
+
+private:
+    Block* blk_;
+};
+
+template<class T, class... A>
+inline UniqueShared<T> make_unique_shared(A&&... args) { return UniqueShared<T>::make(std::forward<A>(args)...); }
+
+#endif // UNIQUE_SHARED_H
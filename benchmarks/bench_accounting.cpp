@@ -0,0 +1,55 @@
+// bench_accounting.cpp
+// -----------------------------------------------------------
+// Cost of the per-type memory accounting, built twice: bench_accounting
+// (no hook) and bench_accounting_on (-DSHPTR_ACCOUNTING).  The accounted
+// build also keeps a mix of objects and arrays alive, some of them made
+// and dropped on other threads, and prints the live-memory snapshot.
+//    ./bench_accounting [iterations]
+// -----------------------------------------------------------------------------
+#include <string>
+#include <thread>
+#include <vector>
+#include "bench_util.h"
+#include "SharedPtr.h"
+#include "SharedPool.h"
+
+struct Small   { long v = 0; };
+struct Message { char header[64]; std::string body; };
+
+int main(int argc, char** argv) {
+    const std::size_t iters = bench::iterations(argc, argv, 10000000);
+
+#ifdef SHPTR_ACCOUNTING
+    std::printf("memory accounting: on\n");
+#else
+    std::printf("memory accounting: off\n");
+#endif
+    bench::row("new + final release, Small", bench::ns_per_op(iters, [](std::size_t) {
+        SharedPtr<Small> p(new Small);
+        bench::keep(p);
+    }));
+    bench::row("make_shared_array<int>(16)", bench::ns_per_op(iters / 4, [](std::size_t) {
+        auto a = make_shared_array<int>(16);
+        bench::keep(a);
+    }));
+    SharedPool<Small> pool;
+    bench::row("pool acquire + release, Small", bench::ns_per_op(iters, [&](std::size_t) {
+        auto p = pool.acquire();
+        bench::keep(p);
+    }));
+
+#ifdef SHPTR_ACCOUNTING
+    std::vector<SharedPtr<Message>> messages;
+    std::vector<SharedPtr<int[]>>   buffers;
+    for(int i = 0; i < 1000; ++i) messages.emplace_back(new Message);
+    for(int i = 0; i < 10; ++i) buffers.push_back(make_shared_array<int>(4096));
+    buffers.emplace_back(new int[100]);                 // length unknown to the block
+    std::vector<SharedPtr<Small>> smalls;
+    std::thread producer([&] { for(int i = 0; i < 5000; ++i) smalls.emplace_back(new Small); });
+    producer.join();
+    smalls.resize(2000);                                // freed here, counted there
+    auto held = pool.acquire();
+    std::printf("\n");
+    print_memory_snapshot();
+#endif
+}
@@ -0,0 +1,53 @@
+// bench_arena.cpp
+// -----------------------------------------------------------
+// A "request": build a tree of SharedPtr nodes, walk it, drop it.  Heap
+// blocks (new per node, delete per node) against make_arena_shared() with
+// one Arena::reset() per request.  Built twice: bench_arena without and
+// bench_arena_debug with the escape-check records (SHPTR_ARENA_DEBUG).
+//    ./bench_arena [requests]
+// -----------------------------------------------------------------------------
+#include "bench_util.h"
+#include "Arena.h"
+#include "SharedPtr.h"
+
+struct Node { SharedPtr<Node> left, right; long payload = 0; };
+
+static SharedPtr<Node> heap_tree(unsigned depth) {
+    SharedPtr<Node> n(new Node);
+    n->payload = depth;
+    if(depth) { n->left = heap_tree(depth - 1); n->right = heap_tree(depth - 1); }
+    return n;
+}
+static SharedPtr<Node> arena_tree(Arena& a, unsigned depth) {
+    SharedPtr<Node> n = make_arena_shared<Node>(a);
+    n->payload = depth;
+    if(depth) { n->left = arena_tree(a, depth - 1); n->right = arena_tree(a, depth - 1); }
+    return n;
+}
+static long sum(const Node* n) { return n ? n->payload + sum(n->left.get()) + sum(n->right.get()) : 0; }
+
+int main(int argc, char** argv) {
+    const std::size_t requests = bench::iterations(argc, argv, 2000);
+    const unsigned depth = 11;                                   // 4095 nodes per request
+    const double nodes = static_cast<double>((1u << (depth + 1)) - 1);
+
+    std::printf("arena escape check: %s\n", SHPTR_ARENA_DEBUG ? "on" : "off");
+    double ns = bench::ns_per_op(requests, [&](std::size_t) {
+        SharedPtr<Node> t = heap_tree(depth);
+        long s = sum(t.get());
+        bench::keep(s);
+    });
+    bench::row("heap blocks (per node)", ns / nodes);
+
+    Arena arena;
+    ns = bench::ns_per_op(requests, [&](std::size_t) {
+        {
+            SharedPtr<Node> t = arena_tree(arena, depth);
+            long s = sum(t.get());
+            bench::keep(s);
+        }
+        arena.reset();
+    });
+    bench::row("arena + reset (per node)", ns / nodes);
+    std::printf("arena chunk bytes kept: %zu\n", arena.bytes_reserved());
+}
@@ -0,0 +1,81 @@
+// bench_cmap.cpp
+// -----------------------------------------------------------
+// ConcurrentMap<K, V> (lock-free lookups, per-shard writers) vs. the
+// usual std::unordered_map<K, SharedPtr<V>> behind one mutex, and behind
+// one std::shared_mutex.  Each thread runs a read-mostly mix over 100k
+// keys: 90 % find, 8 % insert_or_assign, 2 % erase; 1–64 threads.
+//    ./bench_cmap [ops per thread]
+// -----------------------------------------------------------------------------
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "bench_util.h"
+#include "ConcurrentMap.h"
+
+struct Value { long payload[4] = {}; };
+using ValuePtr = SharedPtr<Value>;
+constexpr long kKeys = 100000;
+
+template<class Mutex, bool SharedReads>
+class LockedMap {
+public:
+    ValuePtr find(long k) const {
+        lock_for_read lock(m_);
+        auto it = map_.find(k);
+        return it==map_.end() ? ValuePtr() : it->second;   // the copy happens under the lock
+    }
+    void insert_or_assign(long k, ValuePtr v) { std::lock_guard<Mutex> g(m_); map_[k] = std::move(v); }
+    ValuePtr erase(long k) {
+        std::lock_guard<Mutex> g(m_);
+        auto it = map_.find(k);
+        if(it==map_.end()) return ValuePtr();
+        ValuePtr out = std::move(it->second);
+        map_.erase(it);
+        return out;
+    }
+private:
+    using lock_for_read = typename std::conditional<SharedReads, std::shared_lock<Mutex>, std::lock_guard<Mutex>>::type;
+    mutable Mutex                            m_;
+    std::unordered_map<long, ValuePtr>       map_;
+};
+
+template<class M>
+double run(M& map, unsigned threads, std::size_t ops) {
+    std::vector<std::thread> pool;
+    auto t0 = bench::clock::now();
+    for(unsigned t = 0; t < threads; ++t)
+        pool.emplace_back([&, t] {
+            std::uint64_t x = 0x9e3779b97f4a7c15ull * (t + 1);
+            long hits = 0;
+            for(std::size_t i = 0; i < ops; ++i) {
+                x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+                const long k = static_cast<long>(x % kKeys);
+                const unsigned op = static_cast<unsigned>((x >> 40) % 100);
+                if(op < 90)       hits += static_cast<bool>(map.find(k));
+                else if(op < 98)  map.insert_or_assign(k, ValuePtr(new Value));
+                else              map.erase(k);
+            }
+            bench::keep(hits);
+        });
+    for(auto& th : pool) th.join();
+    return static_cast<double>(threads * ops) / bench::seconds_since(t0) / 1e6;
+}
+
+template<class M>
+void fill(M& map) { for(long k = 0; k < kKeys; ++k) map.insert_or_assign(k, ValuePtr(new Value)); }
+
+int main(int argc, char** argv) {
+    const std::size_t ops = bench::iterations(argc, argv, 400000);
+    std::printf("%-8s %14s %14s %14s   (Mops/s)\n", "threads", "ConcurrentMap", "mutex", "shared_mutex");
+    for(unsigned n : {1u, 2u, 4u, 8u, 16u, 32u, 64u}) {
+        const std::size_t per = ops / n ? ops / n : 1;
+        ConcurrentMap<long, Value> cm;
+        LockedMap<std::mutex, false> mm;
+        LockedMap<std::shared_mutex, true> sm;
+        fill(cm); fill(mm); fill(sm);
+        double a = run(cm, n, per), b = run(mm, n, per), c = run(sm, n, per);
+        std::printf("%-8u %14.2f %14.2f %14.2f\n", n, a, b, c);
+    }
+}
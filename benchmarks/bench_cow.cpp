@@ -0,0 +1,42 @@
+// bench_cow.cpp
+// -----------------------------------------------------------
+// CowPtr<Document> vs. snapshotting by copying a std::vector, for
+// read-heavy and write-heavy mixes.  Every `snapshot_every` operations a
+// reader takes a snapshot that it holds until the next one.
+//    ./bench_cow [operations]
+// -----------------------------------------------------------------------------
+#include <vector>
+#include "bench_util.h"
+#include "CowPtr.h"
+
+using Document = std::vector<int>;
+
+int main(int argc, char** argv) {
+    const std::size_t ops = bench::iterations(argc, argv, 2000000);
+    const std::size_t doc_size = 16384, snapshot_every = 1000;
+
+    std::printf("%-12s %-18s %12s\n", "read/write", "strategy", "ns/op");
+    for(unsigned write_pct : {1u, 10u, 50u, 90u}) {
+        char mix[16]; std::snprintf(mix, sizeof mix, "%u/%u", 100 - write_pct, write_pct);
+
+        CowPtr<Document> doc = CowPtr<Document>::make(doc_size, 1);
+        CowPtr<Document> snap;
+        long sum = 0;
+        double cow = bench::ns_per_op(ops, [&](std::size_t i) {
+            if(i % snapshot_every == 0) snap = doc;
+            if(i % 100 < write_pct) doc.write()[i % doc_size] = static_cast<int>(i);
+            else                    sum += doc.read()[i % doc_size];
+        });
+        bench::keep(sum);
+        std::printf("%-12s %-18s %12.2f\n", mix, "CowPtr", cow);
+
+        Document plain(doc_size, 1), copy;
+        double vec = bench::ns_per_op(ops, [&](std::size_t i) {
+            if(i % snapshot_every == 0) copy = plain;
+            if(i % 100 < write_pct) plain[i % doc_size] = static_cast<int>(i);
+            else                    sum += plain[i % doc_size];
+        });
+        bench::keep(sum);
+        std::printf("%-12s %-18s %12.2f\n", mix, "vector copy", vec);
+    }
+}
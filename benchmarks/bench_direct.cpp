@@ -0,0 +1,69 @@
+// bench_direct.cpp
+// -----------------------------------------------------------
+// One-word SharedPtr (object reached through cb_->ptr) vs. two-word
+// DirectSharedPtr (object pointer in the handle):
+//   * chasing a linked list whose nodes are linked in random order, so
+//     every hop is a cache miss — and a second one for cb_->ptr;
+//   * summing one random element of many small SharedPtr<int[]> arrays.
+//    ./bench_direct [nodes]
+// -----------------------------------------------------------------------------
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "bench_util.h"
+#include "DirectSharedPtr.h"
+
+template<template<class> class Ptr>
+struct Node { Ptr<Node> next; long value = 1; };
+
+template<template<class> class Ptr>
+static double chase(std::size_t n, std::mt19937_64& rng) {
+    using N = Node<Ptr>;
+    // objects first, blocks afterwards: block and object live apart, as
+    // they do in a long-running heap (back-to-back news would put them in
+    // the same cache line and hide the extra load)
+    std::vector<N*> raw(n);
+    for(auto& p : raw) p = new N;
+    std::vector<Ptr<N>> nodes;
+    nodes.reserve(n);
+    for(N* p : raw) nodes.emplace_back(p);
+    std::shuffle(nodes.begin(), nodes.end(), rng);
+    for(std::size_t i = 0; i + 1 < n; ++i) nodes[i]->next = nodes[i + 1];
+    Ptr<N> head = nodes.front();
+    nodes.clear();                          // the list now owns every node
+
+    long sum = 0;
+    const int laps = 3;
+    auto t0 = bench::clock::now();
+    for(int lap = 0; lap < laps; ++lap)
+        for(const N* p = head.get(); p; p = p->next.get()) sum += p->value;
+    bench::keep(sum);
+    return bench::seconds_since(t0) * 1e9 / static_cast<double>(n * laps);
+}
+
+template<class Arr>
+static double gather(std::size_t n, std::mt19937_64& rng) {
+    std::vector<Arr> arrays;
+    arrays.reserve(n);
+    for(std::size_t i = 0; i < n; ++i) arrays.emplace_back(SharedPtr<int[]>(new int[8]()));
+    std::vector<std::uint32_t> idx(n);
+    for(auto& i : idx) i = static_cast<std::uint32_t>(rng() % n);
+
+    long sum = 0;
+    double ns = bench::ns_per_op(n, [&](std::size_t i) { sum += arrays[idx[i]][i & 7]; });
+    bench::keep(sum);
+    return ns;
+}
+
+int main(int argc, char** argv) {
+    const std::size_t n = bench::iterations(argc, argv, 4000000);
+    std::mt19937_64 rng(11);
+
+    std::printf("handle size: SharedPtr %zu bytes, DirectSharedPtr %zu bytes\n",
+                sizeof(SharedPtr<int>), sizeof(DirectSharedPtr<int>));
+    bench::row("list hop, SharedPtr", chase<SharedPtr>(n, rng));
+    bench::row("list hop, DirectSharedPtr", chase<DirectSharedPtr>(n, rng));
+    bench::row("array gather, SharedPtr<int[]>", gather<SharedPtr<int[]>>(n, rng));
+    bench::row("array gather, DirectSharedPtr<int[]>", gather<DirectSharedPtr<int[]>>(n, rng));
+}
@@ -0,0 +1,49 @@
+// bench_hotblocks.cpp
+// -----------------------------------------------------------
+// Copy/release traffic with one hot shared object (every worker copies
+// it) and per-worker private objects.  Built twice: bench_hotblocks and
+// bench_hotblocks_sampled (-DSHPTR_SAMPLE_CB), which also prints the
+// sampler's report: the hot block should top it with full thread fan-in.
+//    ./bench_hotblocks [copies per thread]
+// -----------------------------------------------------------------------------
+#include <string>
+#include <thread>
+#include <vector>
+#include "bench_util.h"
+#include "SharedPtr.h"
+
+struct Config  { std::string name = "global"; };
+struct Session { long id = 0; };
+
+int main(int argc, char** argv) {
+    const std::size_t iters = bench::iterations(argc, argv, 2000000);
+    const unsigned workers = 4;
+
+#ifdef SHPTR_SAMPLE_CB
+    std::printf("control-block sampling: on (1 in ~%u)\n", hot_block_sample_period());
+#else
+    std::printf("control-block sampling: off\n");
+#endif
+    bench::row("copy + release, 1 thread", bench::ns_per_op(iters, [p = SharedPtr<Session>(new Session)](std::size_t) {
+        SharedPtr<Session> c(p); bench::keep(c);
+    }));
+
+    SharedPtr<Config> hot(new Config);
+    std::vector<std::thread> pool;
+    auto t0 = bench::clock::now();
+    for(unsigned w = 0; w < workers; ++w)
+        pool.emplace_back([&hot, iters] {
+            SharedPtr<Session> mine(new Session);
+            for(std::size_t i = 0; i < iters; ++i) {
+                SharedPtr<Config> c(hot); bench::keep(c);                    // every thread
+                if(i % 4==0) { SharedPtr<Session> s(mine); bench::keep(s); } // this thread only
+            }
+        });
+    for(auto& t : pool) t.join();
+    bench::row("mixed workload, per hot copy", bench::seconds_since(t0) * 1e9 / static_cast<double>(iters * workers));
+
+#ifdef SHPTR_SAMPLE_CB
+    std::printf("\n");
+    print_hot_blocks(stdout, 6);
+#endif
+}
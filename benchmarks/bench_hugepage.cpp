@@ -0,0 +1,51 @@
+// bench_hugepage.cpp
+// -----------------------------------------------------------
+// Random lookups into a large SharedPtr<T[]>: new T[n]() vs.
+// make_huge_array<T>(n) (2 MB aligned, MADV_HUGEPAGE).
+//    ./bench_hugepage [megabytes]
+// -----------------------------------------------------------------------------
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include "bench_util.h"
+#include "HugePageArray.h"
+
+// AnonHugePages of this process in kB (0 if unknown)
+static long anon_huge_kb() {
+    std::ifstream in("/proc/self/smaps_rollup");
+    long v = 0;
+    for(std::string line; std::getline(in, line);)
+        if(std::sscanf(line.c_str(), "AnonHugePages: %ld", &v)==1) return v;
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    const std::size_t mb = bench::iterations(argc, argv, 512);
+    const std::size_t n  = mb * 1024 * 1024 / sizeof(std::uint64_t);
+    const std::size_t probes = 20000000;
+
+    std::mt19937_64 rng(7);
+    std::vector<std::uint32_t> idx(1 << 20);
+    for(auto& i : idx) i = static_cast<std::uint32_t>(rng() % n);
+
+    auto run = [&](SharedPtr<std::uint64_t[]> a) {
+        for(std::size_t i = 0; i < n; ++i) a[i] = i;
+        std::uint64_t sum = 0;
+        double ns = bench::ns_per_op(probes, [&](std::size_t i) { sum += a[idx[i & (idx.size() - 1)] ^ (i >> 20)]; });
+        bench::keep(sum);
+        return ns;
+    };
+
+    std::printf("--- %zu MB array, %zu random probes ---\n", mb, probes);
+    double base = run(SharedPtr<std::uint64_t[]>(new std::uint64_t[n]()));
+    bench::row("new T[n]()", base);
+
+    auto huge = make_huge_array<std::uint64_t>(n);
+    std::printf("MADV_HUGEPAGE accepted: %s, AnonHugePages: %ld kB\n", huge_page_advised(huge) ? "yes" : "no", anon_huge_kb());
+    double hp = run(std::move(huge));
+    bench::row("make_huge_array", hp);
+    std::printf("speedup: %.2fx\n", base / hp);
+}
@@ -0,0 +1,79 @@
+// bench_intern.cpp
+// -----------------------------------------------------------
+// Duplicate-heavy data: n handles to 48-character strings drawn from 20k
+// distinct values.  One SharedPtr<const std::string> per value, as parsed
+// today, vs. InternTable<std::string>.  Reports time per handle and
+// resident-set growth per handle; each variant runs in a forked child so
+// it starts from a clean heap.  Then intern() throughput at 1–16 threads.
+//    ./bench_intern [count]
+// -----------------------------------------------------------------------------
+#include <cstdio>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "bench_util.h"
+#include "InternTable.h"
+
+using Handle = SharedPtr<const std::string>;
+constexpr unsigned kDistinct = 20000;
+
+// resident set in bytes, from /proc/self/statm
+static long rss_bytes() {
+    long pages = 0, resident = 0;
+    if(std::FILE* f = std::fopen("/proc/self/statm", "r")) {
+        if(std::fscanf(f, "%ld %ld", &pages, &resident)!=2) resident = 0;
+        std::fclose(f);
+    }
+    return resident * ::sysconf(_SC_PAGESIZE);
+}
+
+// the i-th value of a parsed stream: a few thousand distinct strings
+static std::string value(std::uint64_t i) {
+    std::string s = "region=eu-west-1;tier=standard;shard=";
+    s += std::to_string((i * 0x9e3779b97f4a7c15ull >> 40) % kDistinct);
+    s.resize(48, '.');
+    return s;
+}
+
+template<class Make>
+static void measure(const char* name, std::size_t n, Make make) {
+    std::fflush(stdout);
+    pid_t pid = ::fork();
+    if(pid > 0) { ::waitpid(pid, nullptr, 0); return; }
+    std::vector<Handle> v;
+    v.reserve(n);
+    for(std::size_t i = 0; i < n; ++i) v.emplace_back();   // fault the handle array in first
+    v.clear();
+    const long before = rss_bytes();
+    auto t0 = bench::clock::now();
+    for(std::size_t i = 0; i < n; ++i) v.push_back(make(value(i)));
+    const double ns = bench::seconds_since(t0) * 1e9 / static_cast<double>(n);
+    const double per = static_cast<double>(rss_bytes() - before) / static_cast<double>(n);
+    std::printf("%-40s %10.2f ns/op %8.1f B/handle\n", name, ns, per);
+    if(pid==0) { std::fflush(stdout); ::_exit(0); }   // fork failed: measured in-process
+}
+
+int main(int argc, char** argv) {
+    const std::size_t n = bench::iterations(argc, argv, 2000000);
+
+    measure("SharedPtr<const string>(new ...)", n, [](std::string s) { return Handle(new std::string(std::move(s))); });
+    InternTable<std::string> table;
+    measure("InternTable<string>::intern", n, [&](std::string s) { return table.intern(std::move(s)); });
+
+    std::printf("\n%-8s %14s   (Mops/s, 1024 handles kept per thread)\n", "threads", "intern");
+    for(unsigned t : {1u, 2u, 4u, 8u, 16u}) {
+        const std::size_t per = n / t ? n / t : 1;
+        InternTable<std::string> shared;
+        std::vector<std::thread> pool;
+        auto t0 = bench::clock::now();
+        for(unsigned k = 0; k < t; ++k)
+            pool.emplace_back([&, k] {
+                std::vector<Handle> held(1024);
+                for(std::size_t i = 0; i < per; ++i) held[i & 1023] = shared.intern(value(i * (k + 1)));
+            });
+        for(auto& th : pool) th.join();
+        std::printf("%-8u %14.2f\n", t, static_cast<double>(per * t) / bench::seconds_since(t0) / 1e6);
+    }
+}
@@ -0,0 +1,67 @@
+// bench_layout.cpp
+// -----------------------------------------------------------
+// Memory per live SharedPtr<int>-sized object for each way of building the
+// control block, measured as resident-set growth while n handles are held
+// (handle + block + object + allocator overhead).  Each variant runs in a
+// forked child so it starts from a clean heap.  Also built as
+// bench_layout_count32 (-DSHPTR_COUNT32).
+//    ./bench_layout [count]
+// The default is 10M live pointers, about 800 MB per child.  The 100M-pointer
+// measurement is ./bench_layout 100000000 and needs roughly 8 GB of RAM.
+// Per-pointer figures are already flat at 10M.
+// -----------------------------------------------------------------------------
+#include <cstdio>
+#include <memory>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+#include "bench_util.h"
+#include "SharedPtr.h"
+#include "UniqueShared.h"
+
+struct Payload { int v = 0; };
+struct Free { void operator()(Payload* p) const noexcept { delete p; } };
+
+// resident set in bytes, from /proc/self/statm
+static long rss_bytes() {
+    long pages = 0, resident = 0;
+    if(std::FILE* f = std::fopen("/proc/self/statm", "r")) {
+        if(std::fscanf(f, "%ld %ld", &pages, &resident)!=2) resident = 0;
+        std::fclose(f);
+    }
+    return resident * ::sysconf(_SC_PAGESIZE);
+}
+
+template<class Make>
+static void measure(const char* name, std::size_t n, Make make) {
+    std::fflush(stdout);
+    pid_t pid = ::fork();
+    if(pid > 0) { ::waitpid(pid, nullptr, 0); return; }
+    std::vector<SharedPtr<Payload>> v;
+    v.reserve(n);
+    for(std::size_t i = 0; i < n; ++i) v.emplace_back();   // fault the handle array in first
+    v.clear();
+    const long before = rss_bytes();
+    auto t0 = bench::clock::now();
+    for(std::size_t i = 0; i < n; ++i) v.push_back(make());
+    const double ns = bench::seconds_since(t0) * 1e9 / static_cast<double>(n);
+    const double per = static_cast<double>(rss_bytes() - before) / static_cast<double>(n) + sizeof(SharedPtr<Payload>);
+    std::printf("%-40s %10.2f ns/op %8.1f B/ptr\n", name, ns, per);
+    if(pid==0) { std::fflush(stdout); ::_exit(0); }   // fork failed: measured in-process
+}
+
+int main(int argc, char** argv) {
+    const std::size_t n = bench::iterations(argc, argv, 10000000);
+
+    std::printf("counter word            %zu bytes\n", sizeof(ref_count_t));
+    std::printf("plain block             %zu bytes\n", sizeof(detail::ControlBlock<Payload*>));
+    std::printf("hooked block            %zu bytes\n", sizeof(detail::HookedBlock<Payload*>));
+    std::printf("block + stateless del.  %zu bytes\n", sizeof(detail::DeleterBlock<Payload*, Free>));
+    std::printf("inline (UniqueShared)   %zu bytes\n", sizeof(detail::InlineBlock<Payload>));
+    std::printf("allocate_shared_ptr     %zu bytes\n\n", sizeof(detail::AllocBlock<Payload, std::allocator<Payload>>));
+
+    measure("SharedPtr(new T)", n, [] { return SharedPtr<Payload>(new Payload); });
+    measure("SharedPtr(new T, stateless deleter)", n, [] { return SharedPtr<Payload>(new Payload, Free{}); });
+    measure("make_unique_shared<T>().share()", n, [] { return make_unique_shared<Payload>().share(); });
+    measure("allocate_shared_ptr<T>(std::allocator)", n, [] { return allocate_shared_ptr<Payload>(std::allocator<Payload>()); });
+}
@@ -0,0 +1,90 @@
+// bench_lockfree.cpp
+// -----------------------------------------------------------
+// LockFreeStack / LockFreeQueue (AtomicSharedPtr, split reference counts)
+// vs. a mutex-protected std::deque<SharedPtr<T>>, 1–64 threads, each
+// doing push/pop pairs.  Every run also checks that each pushed item was
+// popped exactly once and that no Item is left alive, so the benchmark
+// doubles as a stress test of the atomic ref_cnt path (exit code 1 on a
+// mismatch).
+//    ./bench_lockfree [pairs per thread]
+// -----------------------------------------------------------------------------
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "bench_util.h"
+#include "LockFreeQueue.h"
+#include "LockFreeStack.h"
+
+static std::atomic<long> live_items{0};
+struct Item {
+    long id;
+    explicit Item(long i) : id(i) { live_items.fetch_add(1, std::memory_order_relaxed); }
+    ~Item() { live_items.fetch_sub(1, std::memory_order_relaxed); }
+};
+using ItemPtr = SharedPtr<Item>;
+
+template<bool Lifo>
+class MutexDeque {
+public:
+    void push(ItemPtr p) { std::lock_guard<std::mutex> g(m_); q_.push_back(std::move(p)); }
+    bool try_pop(ItemPtr& out) {
+        std::lock_guard<std::mutex> g(m_);
+        if(q_.empty()) return false;
+        if(Lifo) { out = std::move(q_.back()); q_.pop_back(); }
+        else     { out = std::move(q_.front()); q_.pop_front(); }
+        return true;
+    }
+private:
+    std::mutex          m_;
+    std::deque<ItemPtr> q_;
+};
+
+static bool ok = true;
+
+template<class C>
+double run(const char* name, unsigned threads, std::size_t pairs) {
+    std::atomic<long> sum{0}, popped{0};
+    double secs;
+    {
+        C c;
+        std::vector<std::thread> pool;
+        auto t0 = bench::clock::now();
+        for(unsigned t = 0; t < threads; ++t)
+            pool.emplace_back([&, t] {
+                long s = 0, n = 0;
+                ItemPtr out;
+                for(std::size_t i = 0; i < pairs; ++i) {
+                    c.push(ItemPtr(new Item(static_cast<long>(t * pairs + i))));
+                    if(c.try_pop(out)) { s += out->id; ++n; }
+                }
+                sum += s; popped += n;
+            });
+        for(auto& th : pool) th.join();
+        secs = bench::seconds_since(t0);
+        ItemPtr out;
+        while(c.try_pop(out)) { sum += out->id; ++popped; }
+    }
+    const long total = static_cast<long>(threads * pairs);
+    if(popped!=total || sum!=total * (total - 1) / 2 || live_items!=0) {
+        std::printf("FAILED %s, %u threads: popped %ld of %ld, %ld items alive\n", name, threads, popped.load(), total, live_items.load());
+        ok = false;
+    }
+    return 2.0 * static_cast<double>(total) / secs / 1e6;
+}
+
+int main(int argc, char** argv) {
+    const std::size_t pairs = bench::iterations(argc, argv, 200000);
+    std::printf("%-8s %14s %14s %14s %14s   (Mops/s)\n", "threads", "LockFreeStack", "mutex LIFO", "LockFreeQueue", "mutex FIFO");
+    for(unsigned n : {1u, 2u, 4u, 8u, 16u, 32u, 64u}) {
+        const std::size_t per = pairs / n ? pairs / n : 1;
+        double s  = run<LockFreeStack<ItemPtr>>("stack", n, per);
+        double ms = run<MutexDeque<true>>("mutex LIFO", n, per);
+        double q  = run<LockFreeQueue<ItemPtr>>("queue", n, per);
+        double mq = run<MutexDeque<false>>("mutex FIFO", n, per);
+        std::printf("%-8u %14.2f %14.2f %14.2f %14.2f\n", n, s, ms, q, mq);
+    }
+    std::printf("checks: %s\n", ok ? "passed" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,90 @@
+// bench_lru.cpp
+// -----------------------------------------------------------
+// LruCache<K, V> (sharded CLOCK) vs. the textbook LRU: std::list plus
+// std::unordered_map behind one mutex, where every hit splices the list.
+// Each thread does get-or-load over 200k keys with a skewed access
+// pattern (80 % of lookups go to 10 % of the keys); the cache holds
+// about a quarter of the keys' bytes.  Prints throughput and hit rate
+// for 1–64 threads.
+//    ./bench_lru [ops per thread]
+// -----------------------------------------------------------------------------
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "bench_util.h"
+#include "LruCache.h"
+
+struct Value { long payload[8] = {}; };
+using ValuePtr = SharedPtr<Value>;
+constexpr long        kKeys  = 200000;
+constexpr std::size_t kBytes = kKeys / 4 * sizeof(Value);
+
+class ListLru {
+public:
+    explicit ListLru(std::size_t max_bytes) : max_(max_bytes / sizeof(Value)) {}
+    ValuePtr find(long k) {
+        std::lock_guard<std::mutex> g(m_);
+        auto it = map_.find(k);
+        if(it==map_.end()) { ++misses_; return ValuePtr(); }
+        order_.splice(order_.begin(), order_, it->second);
+        ++hits_;
+        return it->second->second;
+    }
+    void insert(long k, ValuePtr v) {
+        ValuePtr dropped;
+        std::lock_guard<std::mutex> g(m_);
+        auto it = map_.find(k);
+        if(it!=map_.end()) { it->second->second = std::move(v); order_.splice(order_.begin(), order_, it->second); return; }
+        if(map_.size()==max_) {
+            dropped = std::move(order_.back().second);      // still destroyed under the lock
+            map_.erase(order_.back().first);
+            order_.pop_back();
+        }
+        order_.emplace_front(k, std::move(v));
+        map_[k] = order_.begin();
+    }
+    double hit_rate() const { return double(hits_) / double(hits_ + misses_); }
+private:
+    using Order = std::list<std::pair<long, ValuePtr>>;
+    std::mutex                                   m_;
+    Order                                        order_;
+    std::unordered_map<long, Order::iterator>    map_;
+    std::size_t                                  max_;
+    std::uint64_t                                hits_ = 0, misses_ = 0;
+};
+
+template<class C>
+double run(C& cache, unsigned threads, std::size_t ops) {
+    std::vector<std::thread> pool;
+    auto t0 = bench::clock::now();
+    for(unsigned t = 0; t < threads; ++t)
+        pool.emplace_back([&, t] {
+            std::uint64_t x = 0x9e3779b97f4a7c15ull * (t + 1);
+            long sum = 0;
+            for(std::size_t i = 0; i < ops; ++i) {
+                x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+                const bool hot = (x >> 56) < 205;                   // ~80 %
+                const long k = static_cast<long>(hot ? x % (kKeys / 10) : x % kKeys);
+                ValuePtr v = cache.find(k);
+                if(!v) { v = ValuePtr(new Value); cache.insert(k, v); }
+                sum += v->payload[0];
+            }
+            bench::keep(sum);
+        });
+    for(auto& th : pool) th.join();
+    return static_cast<double>(threads * ops) / bench::seconds_since(t0) / 1e6;
+}
+
+int main(int argc, char** argv) {
+    const std::size_t ops = bench::iterations(argc, argv, 400000);
+    std::printf("%-8s %14s %8s %14s %8s   (Mops/s, hit rate)\n", "threads", "LruCache", "hits", "list+mutex", "hits");
+    for(unsigned n : {1u, 2u, 4u, 8u, 16u, 32u, 64u}) {
+        const std::size_t per = ops / n ? ops / n : 1;
+        LruCache<long, Value> clock(kBytes);
+        ListLru list(kBytes);
+        double a = run(clock, n, per), b = run(list, n, per);
+        std::printf("%-8u %14.2f %7.1f%% %14.2f %7.1f%%\n", n, a, 100 * clock.stats().hit_rate(), b, 100 * list.hit_rate());
+    }
+}
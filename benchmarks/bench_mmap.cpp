@@ -0,0 +1,55 @@
+// bench_mmap.cpp
+// -----------------------------------------------------------
+// Loading a lookup table: read() into new T[] vs. map_file<T>().
+// Reports time-to-first-access, a full sequential scan and random probes.
+//    ./bench_mmap [megabytes]
+// -----------------------------------------------------------------------------
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include "bench_util.h"
+#include "MappedArray.h"
+
+using Entry = std::uint64_t;
+
+int main(int argc, char** argv) {
+    const std::size_t mb = bench::iterations(argc, argv, 256);
+    const std::size_t n  = mb * 1024 * 1024 / sizeof(Entry);
+    const std::string path = "bench_mmap.tmp";
+    {
+        std::vector<Entry> v(n);
+        for(std::size_t i = 0; i < n; ++i) v[i] = i * 2654435761u;
+        std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(v.data()), static_cast<std::streamsize>(n * sizeof(Entry)));
+    }
+    std::mt19937_64 rng(42);
+    std::vector<std::size_t> probes(1000000);
+    for(auto& p : probes) p = rng() % n;
+
+    auto measure = [&](const char* name, auto load) {
+        auto t0 = bench::clock::now();
+        auto table = load();
+        double ready = bench::seconds_since(t0);
+        Entry sum = 0;
+        t0 = bench::clock::now();
+        for(std::size_t i = 0; i < n; ++i) sum += table[i];
+        double scan = bench::seconds_since(t0);
+        t0 = bench::clock::now();
+        for(std::size_t p : probes) sum += table[p];
+        double rnd = bench::seconds_since(t0) * 1e9 / probes.size();
+        bench::keep(sum);
+        std::printf("%-22s ready %8.2f ms   scan %8.2f ms   random %6.1f ns/probe\n", name, ready * 1e3, scan * 1e3, rnd);
+    };
+
+    std::printf("--- %zu MB table ---\n", mb);
+    measure("read() into new T[]", [&] {
+        SharedPtr<Entry[]> a(new Entry[n]);
+        std::ifstream(path, std::ios::binary).read(reinterpret_cast<char*>(a.get()), static_cast<std::streamsize>(n * sizeof(Entry)));
+        return a;
+    });
+    measure("map_file (lazy)", [&] { return map_file<const Entry>(path); });
+    measure("map_file (willneed)", [&] { return map_file<const Entry>(path, {MapMode::ReadOnly, AdviseWillNeed | AdviseSequential}); });
+    std::remove(path.c_str());
+}
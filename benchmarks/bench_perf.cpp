@@ -0,0 +1,72 @@
+// bench_perf.cpp
+// -----------------------------------------------------------
+// SharedPtr operations with hardware counters per operation (see
+// perf_counters.h): single-threaded copies, copies of one shared block
+// from several threads (the counter's cache line bounces between cores)
+// vs. private blocks per thread, and the one- vs. two-word handle layout.
+//    ./bench_perf [iterations]
+//    SHPTR_PERF_RAW=0x04d2 ./bench_perf     # + a raw event, here Skylake HITM
+// -----------------------------------------------------------------------------
+#include <random>
+#include <thread>
+#include <vector>
+#include "perf_counters.h"
+#include "DirectSharedPtr.h"
+#include "SharedPool.h"
+
+struct Payload { long v = 1; };
+
+// `threads` workers each run `per_thread` copy+release pairs on blocks[t % blocks.size()]
+static void contended(bench::PerfCounters& pc, const char* name, unsigned threads, std::size_t per_thread,
+                      const std::vector<SharedPtr<Payload>>& blocks) {
+    std::vector<std::thread> pool;
+    pc.start();
+    auto t0 = bench::clock::now();
+    for(unsigned t = 0; t < threads; ++t)
+        pool.emplace_back([&, t] {
+            const SharedPtr<Payload>& src = blocks[t % blocks.size()];
+            for(std::size_t i = 0; i < per_thread; ++i) { SharedPtr<Payload> c(src); bench::keep(c); }
+        });
+    for(auto& th : pool) th.join();
+    const double ops = static_cast<double>(per_thread) * threads;
+    const double ns  = bench::seconds_since(t0) * 1e9 / ops;
+    pc.stop();
+    std::printf("%-34s %8.2f ns/op", name, ns);
+    pc.print(ops);
+}
+
+int main(int argc, char** argv) {
+    const std::size_t iters = bench::iterations(argc, argv, 5000000);
+    bench::PerfCounters pc;
+    if(!pc.available())
+        std::printf("(hardware counters unavailable: not Linux, no PMU, or perf_event_paranoid > 2; timing only)\n");
+
+    SharedPtr<Payload> p(new Payload);
+    bench::perf_row(pc, "copy + release, 1 thread", iters, [&](std::size_t) { SharedPtr<Payload> c(p); bench::keep(c); });
+    bench::perf_row(pc, "new + final release", iters / 4, [](std::size_t) { SharedPtr<Payload> c(new Payload); bench::keep(c); });
+    SharedPool<Payload> pool;
+    bench::perf_row(pc, "SharedPool acquire + release", iters / 4, [&](std::size_t) { auto c = pool.acquire(); bench::keep(c); });
+
+    const unsigned hw = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 4;
+    const unsigned threads = hw < 4 ? 4 : hw;
+    std::vector<SharedPtr<Payload>> one{p}, own;
+    for(unsigned t = 0; t < threads; ++t) own.emplace_back(new Payload);
+    char label[64];
+    std::snprintf(label, sizeof label, "copy + release, %u thr, 1 block", threads);
+    contended(pc, label, threads, iters / threads, one);
+    std::snprintf(label, sizeof label, "copy + release, %u thr, own blocks", threads);
+    contended(pc, label, threads, iters / threads, own);
+
+    // handle layout: random gathers through many small arrays
+    const std::size_t n = 1 << 20;
+    std::vector<SharedPtr<int[]>> one_word;
+    std::vector<DirectSharedPtr<int[]>> two_word;
+    for(std::size_t i = 0; i < n; ++i) { one_word.emplace_back(new int[8]()); two_word.emplace_back(one_word.back()); }
+    std::mt19937_64 rng(3);
+    std::vector<std::uint32_t> idx(n);
+    for(auto& i : idx) i = static_cast<std::uint32_t>(rng() % n);
+    long sum = 0;
+    bench::perf_row(pc, "gather, SharedPtr<int[]>", n, [&](std::size_t i) { sum += one_word[idx[i]][i & 7]; });
+    bench::perf_row(pc, "gather, DirectSharedPtr<int[]>", n, [&](std::size_t i) { sum += two_word[idx[i]][i & 7]; });
+    bench::keep(sum);
+}
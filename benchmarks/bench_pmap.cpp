@@ -0,0 +1,46 @@
+// bench_pmap.cpp
+// -----------------------------------------------------------
+// Snapshot-per-update cost: PersistentMap (HAMT) vs. copying a
+// std::unordered_map, plus lookup cost for both.
+//    ./bench_pmap [updates]
+// -----------------------------------------------------------------------------
+#include <cstdint>
+#include <unordered_map>
+#include "bench_util.h"
+#include "PersistentMap.h"
+
+using Route = std::uint64_t;
+
+int main(int argc, char** argv) {
+    const std::size_t updates = bench::iterations(argc, argv, 20000);
+
+    std::printf("%-10s %-28s %14s\n", "routes", "operation", "ns/op");
+    for(std::size_t n : {1000u, 100000u, 1000000u}) {
+        auto build = PersistentMap<Route, Route>().transient();
+        std::unordered_map<Route, Route> plain;
+        for(Route i = 0; i < n; ++i) { build.insert(i * 2654435761u, i); plain.emplace(i * 2654435761u, i); }
+        PersistentMap<Route, Route> table = std::move(build).persistent();
+
+        PersistentMap<Route, Route> snap;
+        double p = bench::ns_per_op(updates, [&](std::size_t i) {
+            snap = table;                               // readers keep the old version
+            table = table.insert(((i * 7919) % n) * 2654435761u, i);
+        });
+        std::printf("%-10zu %-28s %14.1f\n", n, "PersistentMap insert+snapshot", p);
+
+        std::unordered_map<Route, Route> copy;
+        const std::size_t reps = n >= 100000 ? updates / 100 : updates;   // full copies are slow
+        double u = bench::ns_per_op(reps, [&](std::size_t i) {
+            copy = plain;
+            plain[((i * 7919) % n) * 2654435761u] = i;
+        });
+        std::printf("%-10zu %-28s %14.1f\n", n, "unordered_map copy+insert", u);
+
+        Route sum = 0;
+        double fp = bench::ns_per_op(updates, [&](std::size_t i) { sum += *table.find(((i * 31) % n) * 2654435761u); });
+        double fu = bench::ns_per_op(updates, [&](std::size_t i) { sum += plain.find(((i * 31) % n) * 2654435761u)->second; });
+        std::printf("%-10zu %-28s %14.1f\n", n, "PersistentMap find", fp);
+        std::printf("%-10zu %-28s %14.1f\n", n, "unordered_map find", fu);
+        bench::keep(sum); bench::keep(snap.size()); bench::keep(copy.size());
+    }
+}
@@ -0,0 +1,48 @@
+// bench_pmr.cpp
+// -----------------------------------------------------------
+// make_pmr_shared() over the standard resources, picked at run time,
+// against SharedPtr(new T): create + final release of a small object, and
+// of a 64-element array.
+//    ./bench_pmr [iterations]
+// -----------------------------------------------------------------------------
+#include <memory_resource>
+#include "bench_util.h"
+#include "PmrShared.h"
+#include "SharedPtr.h"
+
+struct Small { long a = 0, b = 0; };
+
+static void run(const char* name, std::pmr::memory_resource* r, std::size_t iters) {
+    char label[64];
+    std::snprintf(label, sizeof label, "%s, object", name);
+    bench::row(label, bench::ns_per_op(iters, [&](std::size_t) {
+        SharedPtr<Small> p = make_pmr_shared<Small>(r);
+        bench::keep(p);
+    }));
+    std::snprintf(label, sizeof label, "%s, double[64]", name);
+    bench::row(label, bench::ns_per_op(iters / 4, [&](std::size_t) {
+        SharedPtr<double[]> p = make_pmr_shared_array<double>(r, 64);
+        bench::keep(p);
+    }));
+}
+
+int main(int argc, char** argv) {
+    const std::size_t iters = bench::iterations(argc, argv, 5000000);
+
+    bench::row("SharedPtr(new), object", bench::ns_per_op(iters, [](std::size_t) {
+        SharedPtr<Small> p(new Small);
+        bench::keep(p);
+    }));
+    bench::row("make_shared_array, double[64]", bench::ns_per_op(iters / 4, [](std::size_t) {
+        SharedPtr<double[]> p = make_shared_array<double>(64);
+        bench::keep(p);
+    }));
+
+    run("new_delete_resource", std::pmr::new_delete_resource(), iters);
+    std::pmr::unsynchronized_pool_resource upool;
+    run("unsynchronized_pool_resource", &upool, iters);
+    std::pmr::synchronized_pool_resource spool;
+    run("synchronized_pool_resource", &spool, iters);
+    std::pmr::monotonic_buffer_resource mono;               // grows for the whole run
+    run("monotonic_buffer_resource", &mono, iters / 10);
+}
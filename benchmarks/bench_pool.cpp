@@ -0,0 +1,58 @@
+// bench_pool.cpp
+// -----------------------------------------------------------
+// SharedPool<T> vs. plain SharedPtr(new T) churn.
+//    ./bench_pool [iterations]
+// -----------------------------------------------------------------------------
+#include <thread>
+#include <vector>
+#include "bench_util.h"
+#include "SharedPool.h"
+
+struct Message {
+    char        payload[256];
+    std::size_t len = 0;
+};
+
+int main(int argc, char** argv) {
+    const std::size_t iters = bench::iterations(argc, argv, 2000000);
+    const std::size_t batch = 64;
+
+    std::printf("--- single-thread churn (%zu ops) ---\n", iters);
+    bench::row("SharedPtr(new Message)", bench::ns_per_op(iters, [](std::size_t i) {
+        SharedPtr<Message> p(new Message);
+        p->len = i;
+        bench::keep(p->len);
+    }));
+
+    SharedPool<Message> pool(batch, [](Message& m) { m.len = 0; });
+    bench::row("SharedPool<Message>::acquire", bench::ns_per_op(iters, [&](std::size_t i) {
+        SharedPtr<Message> p = pool.acquire();
+        p->len = i;
+        bench::keep(p->len);
+    }));
+
+    std::printf("--- batches of %zu live objects ---\n", batch);
+    std::vector<SharedPtr<Message>> live(batch);
+    bench::row("SharedPtr(new Message)", bench::ns_per_op(iters / batch, [&](std::size_t) {
+        for(auto& p : live) p.reset(new Message);
+    }) / batch);
+    bench::row("SharedPool<Message>::acquire", bench::ns_per_op(iters / batch, [&](std::size_t) {
+        for(auto& p : live) p = pool.acquire();
+    }) / batch);
+    for(auto& p : live) p.reset();
+
+    std::printf("--- cross-thread release (%zu ops) ---\n", iters);
+    auto cross = [&](auto make) {
+        std::vector<SharedPtr<Message>> box;
+        auto t0 = bench::clock::now();
+        for(std::size_t done = 0; done < iters; done += batch) {
+            box.clear();
+            for(std::size_t i = 0; i < batch; ++i) box.push_back(make());
+            std::thread([b = std::move(box)]() mutable { b.clear(); }).join();
+        }
+        return bench::seconds_since(t0) * 1e9 / static_cast<double>(iters);
+    };
+    bench::row("SharedPtr(new Message)", cross([] { return SharedPtr<Message>(new Message); }));
+    bench::row("SharedPool<Message>::acquire", cross([&] { return pool.acquire(); }));
+    std::printf("pool cached after run: %zu\n", pool.cached());
+}
@@ -0,0 +1,48 @@
+// bench_pvector.cpp
+// -----------------------------------------------------------
+// PersistentVector snapshots vs. copying a std::vector on every update,
+// plus bulk building through push_back, a Transient and std::vector.
+//    ./bench_pvector [updates]
+// -----------------------------------------------------------------------------
+#include <vector>
+#include "bench_util.h"
+#include "PersistentVector.h"
+
+int main(int argc, char** argv) {
+    const std::size_t updates = bench::iterations(argc, argv, 20000);
+
+    std::printf("--- one snapshot per update (%zu updates) ---\n", updates);
+    std::printf("%-10s %-22s %14s\n", "size", "strategy", "ns/update");
+    for(std::size_t n : {1000u, 100000u, 1000000u}) {
+        auto build = PersistentVector<int>().transient();
+        std::vector<int> plain;
+        for(std::size_t i = 0; i < n; ++i) { build.push_back(static_cast<int>(i)); plain.push_back(static_cast<int>(i)); }
+        PersistentVector<int> pv = std::move(build).persistent();
+
+        PersistentVector<int> snap;
+        double p = bench::ns_per_op(updates, [&](std::size_t i) {
+            snap = pv;                                  // readers keep the old version
+            pv = pv.set((i * 7919) % n, static_cast<int>(i));
+        });
+        std::printf("%-10zu %-22s %14.1f\n", n, "PersistentVector::set", p);
+
+        std::vector<int> copy;
+        const std::size_t reps = n >= 1000000 ? updates / 20 : updates;   // full copies are slow
+        double v = bench::ns_per_op(reps, [&](std::size_t i) {
+            copy = plain;
+            plain[(i * 7919) % n] = static_cast<int>(i);
+        });
+        std::printf("%-10zu %-22s %14.1f\n", n, "std::vector copy+set", v);
+        bench::keep(snap[0]); bench::keep(copy[0]);
+    }
+
+    const std::size_t n = 1000000;
+    std::printf("--- building %zu elements ---\n", n);
+    PersistentVector<int> pv;
+    bench::row("PersistentVector::push_back", bench::ns_per_op(n, [&](std::size_t i) { pv = pv.push_back(static_cast<int>(i)); }));
+    auto t = PersistentVector<int>().transient();
+    bench::row("Transient::push_back", bench::ns_per_op(n, [&](std::size_t i) { t.push_back(static_cast<int>(i)); }));
+    std::vector<int> v;
+    bench::row("std::vector::push_back", bench::ns_per_op(n, [&](std::size_t i) { v.push_back(static_cast<int>(i)); }));
+    bench::keep(pv[n - 1]); bench::keep(t[n - 1]); bench::keep(v[n - 1]);
+}
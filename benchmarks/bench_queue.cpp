@@ -0,0 +1,85 @@
+// bench_queue.cpp
+// -----------------------------------------------------------
+// SharedQueue<SharedPtr<T>> (ownership moved, no refcount traffic) vs. a
+// mutex-protected std::deque that copies SharedPtrs in and out.
+// Reports throughput and push→pop latency for 1–32 producers/consumers.
+//    ./bench_queue [items per producer]
+// -----------------------------------------------------------------------------
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "bench_util.h"
+#include "SharedQueue.h"
+
+struct Item {
+    bench::clock::time_point pushed;
+};
+using ItemPtr = SharedPtr<Item>;
+
+// Baseline: what the handoff queues do today.
+class MutexQueue {
+public:
+    bool try_push(const ItemPtr& p) { std::lock_guard<std::mutex> g(m_); q_.push_back(p); return true; }
+    bool try_pop(ItemPtr& out) {
+        std::lock_guard<std::mutex> g(m_);
+        if(q_.empty()) return false;
+        out = q_.front(); q_.pop_front();
+        return true;
+    }
+private:
+    std::mutex          m_;
+    std::deque<ItemPtr> q_;
+};
+
+struct Result { double mops, p50_ns, p99_ns; };
+
+template<class Q>
+Result run(Q& q, unsigned threads, std::size_t per_producer) {
+    std::atomic<std::size_t> consumed{0};
+    const std::size_t total = threads * per_producer;
+    std::vector<std::vector<double>> lat(threads);
+    std::vector<std::thread> pool;
+
+    auto t0 = bench::clock::now();
+    for(unsigned t = 0; t < threads; ++t) {
+        pool.emplace_back([&] {
+            for(std::size_t i = 0; i < per_producer; ++i) {
+                ItemPtr p(new Item);
+                p->pushed = bench::clock::now();
+                while(!q.try_push(p)) std::this_thread::yield();
+            }
+        });
+        pool.emplace_back([&, t] {
+            ItemPtr p;
+            auto& mine = lat[t];
+            while(consumed.load(std::memory_order_relaxed) < total) {
+                if(!q.try_pop(p)) { std::this_thread::yield(); continue; }
+                mine.push_back(std::chrono::duration<double, std::nano>(bench::clock::now() - p->pushed).count());
+                consumed.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+    for(auto& th : pool) th.join();
+    double secs = bench::seconds_since(t0);
+
+    std::vector<double> all;
+    for(auto& v : lat) all.insert(all.end(), v.begin(), v.end());
+    std::sort(all.begin(), all.end());
+    return { total / secs / 1e6, all[all.size() / 2], all[all.size() * 99 / 100] };
+}
+
+int main(int argc, char** argv) {
+    const std::size_t per_producer = bench::iterations(argc, argv, 100000);
+    std::printf("%-8s %-14s %10s %12s %12s\n", "threads", "queue", "Mops/s", "p50 ns", "p99 ns");
+    for(unsigned n : {1u, 2u, 4u, 8u, 16u, 32u}) {
+        SharedQueue<ItemPtr> lf(1024);
+        Result a = run(lf, n, per_producer / n);
+        std::printf("%-8u %-14s %10.2f %12.0f %12.0f\n", n, "SharedQueue", a.mops, a.p50_ns, a.p99_ns);
+        MutexQueue mq;
+        Result b = run(mq, n, per_producer / n);
+        std::printf("%-8u %-14s %10.2f %12.0f %12.0f\n", n, "mutex+deque", b.mops, b.p50_ns, b.p99_ns);
+    }
+}
@@ -0,0 +1,50 @@
+// bench_release.cpp
+// -----------------------------------------------------------
+// Cost of a final release, built twice: bench_release (no hook) and
+// bench_release_timed (-DSHPTR_RELEASE_TIMING).  The timed build also
+// releases a few differently expensive types from two threads and prints
+// the per-type latency percentiles.
+//    ./bench_release [iterations]
+// -----------------------------------------------------------------------------
+#include <thread>
+#include <vector>
+#include "bench_util.h"
+#include "SharedPtr.h"
+
+struct Small { long v = 0; };
+struct Big   { std::vector<char> bytes = std::vector<char>(1 << 20, 1); };
+struct Tree  { SharedPtr<Tree> left, right; };
+
+static SharedPtr<Tree> tree(unsigned depth) {
+    SharedPtr<Tree> t(new Tree);
+    if(depth) { t->left = tree(depth - 1); t->right = tree(depth - 1); }
+    return t;
+}
+
+int main(int argc, char** argv) {
+    const std::size_t iters = bench::iterations(argc, argv, 10000000);
+
+#ifdef SHPTR_RELEASE_TIMING
+    std::printf("final-release timing: on\n");
+#else
+    std::printf("final-release timing: off\n");
+#endif
+    bench::row("new + final release, Small", bench::ns_per_op(iters, [](std::size_t) {
+        SharedPtr<Small> p(new Small);
+        bench::keep(p);
+    }));
+
+#ifdef SHPTR_RELEASE_TIMING
+    release_latency_reset();
+    auto work = [] {
+        for(int i = 0; i < 200; ++i) { SharedPtr<Big> b(new Big); bench::keep(b); }
+        for(int i = 0; i < 20; ++i) tree(12).reset();
+        for(int i = 0; i < 100000; ++i) { SharedPtr<Small> s(new Small); bench::keep(s); }
+    };
+    std::thread other(work);
+    work();
+    other.join();
+    std::printf("\n");
+    print_release_latency();
+#endif
+}
@@ -0,0 +1,64 @@
+// bench_shm.cpp
+// -----------------------------------------------------------
+// ShmSharedPtr across processes: N forked workers attach to one segment,
+// look up a shared dataset and churn references to it; then a worker that
+// dies while holding references is reaped.
+//    ./bench_shm [copies per worker]
+// -----------------------------------------------------------------------------
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include "bench_util.h"
+#include "ShmSharedPtr.h"
+
+int main(int argc, char** argv) {
+    const std::size_t copies = bench::iterations(argc, argv, 2000000);
+    const std::string name = "/shptr_bench_" + std::to_string(::getpid());
+    const std::size_t elems = 1 << 20;
+
+    auto seg = ShmSegment::create(name, 64u << 20);
+    {
+        auto data = seg->make_array<std::uint64_t>(elems);
+        for(std::size_t i = 0; i < elems; ++i) data[i] = i;
+        seg->publish(0, data);
+    }
+
+    std::printf("%-10s %16s %16s\n", "workers", "ns/copy+drop", "dataset sum ok");
+    for(int workers : {1, 2, 4, 8}) {
+        auto t0 = bench::clock::now();
+        for(int w = 0; w < workers; ++w) {
+            if(::fork()==0) {
+                std::uint64_t sum = 0;
+                {
+                    auto mine = ShmSegment::open(name);
+                    auto data = mine->lookup<std::uint64_t>(0);
+                    for(std::size_t i = 0; i < copies; ++i) { ShmSharedPtr<std::uint64_t> c(data); bench::keep(c); }
+                    for(std::size_t i = 0; i < data.size(); ++i) sum += data[i];
+                }
+                std::_Exit(sum==std::uint64_t(elems) * (elems - 1) / 2 ? 0 : 1);
+            }
+        }
+        bool ok = true;
+        for(int w = 0; w < workers; ++w) { int st; ::wait(&st); ok = ok && WIFEXITED(st) && WEXITSTATUS(st)==0; }
+        double ns = bench::seconds_since(t0) * 1e9 / (double(copies) * workers);
+        std::printf("%-10d %16.2f %16s\n", workers, ns, ok ? "yes" : "NO");
+    }
+
+    auto data = seg->lookup<std::uint64_t>(0);
+    std::size_t before = data.use_count();
+    if(::fork()==0) {
+        auto mine = ShmSegment::open(name);
+        std::vector<ShmSharedPtr<std::uint64_t>> leaked(1000, mine->lookup<std::uint64_t>(0));
+        std::_Exit(0);                                  // dies without releasing anything
+    }
+    int st; ::wait(&st);
+    std::size_t crashed = data.use_count();
+    std::size_t reaped = seg->reap();
+    std::printf("crash test: use_count %zu -> %zu after crash -> %zu after reaping %zu process(es)\n",
+                before, crashed, data.use_count(), reaped);
+
+    data.reset();
+    seg.reset();
+    ShmSegment::unlink(name);
+}
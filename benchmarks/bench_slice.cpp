@@ -0,0 +1,66 @@
+// bench_slice.cpp
+// -----------------------------------------------------------
+// Keeping parsed fields of a shared buffer: a 64 MiB SharedPtr<char[]>
+// of length-prefixed records (16–255 bytes), every record kept past the
+// parse.  Copying each one into a std::vector<char> or into its own
+// make_shared_array<char>() is compared with SharedPtr<T[]>::slice(),
+// which only bumps the buffer's count.
+//    ./bench_slice [buffer MiB]
+// -----------------------------------------------------------------------------
+#include <cstring>
+#include <vector>
+#include "bench_util.h"
+#include "SharedPtr.h"
+
+using Buffer = SharedPtr<char[]>;
+
+static std::size_t fill(const Buffer& buf, std::size_t bytes) {
+    std::uint64_t x = 0x9e3779b97f4a7c15ull;
+    std::size_t off = 0, records = 0;
+    while(off + 256 <= bytes) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        const std::size_t len = 16 + x % 240;
+        buf[off] = static_cast<char>(len);
+        std::memset(buf.get() + off + 1, 'a' + static_cast<int>(x % 26), len);
+        off += 1 + len;
+        ++records;
+    }
+    buf[off] = 0;                                   // end marker
+    return records;
+}
+
+// Calls keep(offset, len) for every record in the buffer.
+template<class Keep>
+static void parse(const Buffer& buf, Keep keep) {
+    for(std::size_t off = 0; const std::size_t len = static_cast<unsigned char>(buf[off]); off += 1 + len)
+        keep(off + 1, len);
+}
+
+template<class V, class Keep>
+static void measure(const char* name, const Buffer& buf, std::size_t records, Keep keep) {
+    std::vector<V> kept;
+    kept.reserve(records);
+    auto t0 = bench::clock::now();
+    parse(buf, [&](std::size_t off, std::size_t len) { kept.push_back(keep(off, len)); });
+    bench::row(name, bench::seconds_since(t0) * 1e9 / static_cast<double>(records));
+    bench::keep(kept.size());
+}
+
+int main(int argc, char** argv) {
+    const std::size_t bytes = bench::iterations(argc, argv, 64) << 20;
+    Buffer buf = make_shared_array<char>(bytes);
+    const std::size_t records = fill(buf, bytes);
+    std::printf("%zu records in %zu MiB; ns per kept record\n", records, bytes >> 20);
+
+    measure<std::vector<char>>("copy into std::vector<char>", buf, records, [&](std::size_t off, std::size_t len) {
+        return std::vector<char>(buf.get() + off, buf.get() + off + len);
+    });
+    measure<Buffer>("copy into make_shared_array<char>", buf, records, [&](std::size_t off, std::size_t len) {
+        Buffer b = make_shared_array<char>(len);
+        std::memcpy(b.get(), buf.get() + off, len);
+        return b;
+    });
+    measure<SharedSpan<char>>("SharedPtr<char[]>::slice", buf, records, [&](std::size_t off, std::size_t len) {
+        return buf.slice(off, len);
+    });
+}
@@ -0,0 +1,46 @@
+// bench_teardown.cpp
+// -----------------------------------------------------------
+// Teardown cost of big SharedPtr graphs with the iterative release queue:
+// a long singly linked list (would overflow the stack if released
+// recursively) and a balanced binary tree, the latter also with
+// std::shared_ptr for reference.
+//    ./bench_teardown [nodes]
+// -----------------------------------------------------------------------------
+#include <memory>
+#include "bench_util.h"
+#include "SharedPtr.h"
+
+struct ListNode { SharedPtr<ListNode> next; long payload = 0; };
+struct TreeNode { SharedPtr<TreeNode> left, right; long payload = 0; };
+struct StdTreeNode { std::shared_ptr<StdTreeNode> left, right; long payload = 0; };
+
+template<class Node, class Ptr>
+Ptr build_tree(unsigned depth) {
+    Ptr n(new Node);
+    if(depth) { n->left = build_tree<Node, Ptr>(depth - 1); n->right = build_tree<Node, Ptr>(depth - 1); }
+    return n;
+}
+
+int main(int argc, char** argv) {
+    const std::size_t nodes = bench::iterations(argc, argv, 4000000);
+
+    SharedPtr<ListNode> head;
+    for(std::size_t i = 0; i < nodes; ++i) { SharedPtr<ListNode> n(new ListNode); n->next = std::move(head); head = std::move(n); }
+    auto t0 = bench::clock::now();
+    head.reset();
+    bench::row("list teardown (per node)", bench::seconds_since(t0) * 1e9 / nodes);
+
+    unsigned depth = 0;
+    while((std::size_t(2) << depth) <= nodes) ++depth;
+    const double tree_nodes = static_cast<double>((std::size_t(2) << depth) - 1);
+
+    auto tree = build_tree<TreeNode, SharedPtr<TreeNode>>(depth);
+    t0 = bench::clock::now();
+    tree.reset();
+    bench::row("tree teardown, SharedPtr (per node)", bench::seconds_since(t0) * 1e9 / tree_nodes);
+
+    auto std_tree = build_tree<StdTreeNode, std::shared_ptr<StdTreeNode>>(depth);
+    t0 = bench::clock::now();
+    std_tree.reset();
+    bench::row("tree teardown, std::shared_ptr (per node)", bench::seconds_since(t0) * 1e9 / tree_nodes);
+}
@@ -0,0 +1,49 @@
+// bench_util.h
+// -----------------------------------------------------------
+// Tiny timing helpers shared by the SharedPtr benchmarks.
+// -----------------------------------------------------------------------------
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+
+namespace bench {
+
+using clock = std::chrono::steady_clock;
+
+inline double seconds_since(clock::time_point t0) {
+    return std::chrono::duration<double>(clock::now() - t0).count();
+}
+
+// Runs f() `iters` times and returns nanoseconds per call.
+template<class F>
+double ns_per_op(std::size_t iters, F&& f) {
+    auto t0 = clock::now();
+    for(std::size_t i = 0; i < iters; ++i) f(i);
+    return seconds_since(t0) * 1e9 / static_cast<double>(iters);
+}
+
+// Keeps the optimiser from discarding a computed value.
+template<class T>
+inline void keep(const T& v) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r"(&v) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &v;
+#endif
+}
+
+// Iteration count, overridable from the command line: ./bench_x 1000000
+inline std::size_t iterations(int argc, char** argv, std::size_t dflt) {
+    return argc > 1 ? std::strtoull(argv[1], nullptr, 10) : dflt;
+}
+
+inline void row(const char* name, double ns) { std::printf("%-40s %10.2f ns/op\n", name, ns); }
+
+} // namespace bench
+
+#endif // BENCH_UTIL_H
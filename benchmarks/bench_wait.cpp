@@ -0,0 +1,80 @@
+// bench_wait.cpp
+// -----------------------------------------------------------
+// Writer/reader handoff: each round the writer hands copies of one
+// SharedPtr to the readers, then waits until it is unique again before
+// mutating in place — by spinning on unique() or with wait_until_unique()
+// (futex-backed with C++20).  Reports round time and the writer's CPU
+// time per round; spinning burns a core the readers could have used.
+//    ./bench_wait [rounds]
+// -----------------------------------------------------------------------------
+#include <atomic>
+#include <ctime>
+#include <thread>
+#include <vector>
+#include "bench_util.h"
+#include "SharedPtr.h"
+
+struct Payload { long v = 0; };
+
+static double thread_cpu_seconds() {
+    timespec ts;
+    ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1e-9;
+}
+
+static void busy_for(double seconds) {
+    auto t0 = bench::clock::now();
+    while(bench::seconds_since(t0) < seconds) {}
+}
+
+template<bool UseWait>
+static void handoff(const char* name, std::size_t rounds, unsigned readers) {
+    std::vector<SharedPtr<Payload>> slots(readers);
+    std::atomic<std::size_t> gen{0};
+    std::vector<std::thread> pool;
+    for(unsigned r = 0; r < readers; ++r)
+        pool.emplace_back([&, r] {
+            for(std::size_t seen = 0; seen < rounds; ) {
+                std::size_t g = gen.load(std::memory_order_acquire);
+                if(g==seen) { std::this_thread::yield(); continue; }
+                seen = g;
+                SharedPtr<Payload> mine = std::move(slots[r]);
+                bench::keep(mine->v);
+                busy_for(20e-6);                    // "read" for 20 us, then let go
+            }
+        });
+
+    SharedPtr<Payload> p(new Payload);
+    const double cpu0 = thread_cpu_seconds();
+    auto t0 = bench::clock::now();
+    for(std::size_t i = 0; i < rounds; ++i) {
+        for(auto& s : slots) s = p;
+        gen.store(i + 1, std::memory_order_release);
+        if(UseWait) p.wait_until_unique();
+        else        while(!p.unique()) {}
+        ++p->v;                                     // exclusive again: mutate in place
+    }
+    const double wall = bench::seconds_since(t0);
+    const double cpu  = thread_cpu_seconds() - cpu0;
+    for(auto& t : pool) t.join();
+    std::printf("%-34s %10.2f us/round %10.2f us writer CPU/round\n", name,
+                wall * 1e6 / static_cast<double>(rounds), cpu * 1e6 / static_cast<double>(rounds));
+}
+
+int main(int argc, char** argv) {
+    const std::size_t rounds = bench::iterations(argc, argv, 2000);
+    const unsigned readers = 3;
+
+#ifdef SHPTR_ATOMIC_WAIT
+    std::printf("wait_until_unique: atomic wait/notify\n");
+#else
+    std::printf("wait_until_unique: yield loop (no C++20 atomic wait)\n");
+#endif
+    handoff<false>("spin on unique()", rounds, readers);
+    handoff<true>("wait_until_unique()", rounds, readers);
+
+    // release() only notifies while a waiter is registered: the plain
+    // copy/release path must not get slower.
+    SharedPtr<Payload> p(new Payload);
+    bench::row("copy + release, no waiter", bench::ns_per_op(20000000, [&](std::size_t) { SharedPtr<Payload> c(p); bench::keep(c); }));
+}
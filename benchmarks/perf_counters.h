@@ -0,0 +1,139 @@
+// perf_counters.h
+// -----------------------------------------------------------
+// Hardware counters for the benchmarks through Linux perf_event_open(2):
+// cycles, instructions, cache misses, L1D read misses, context switches
+// (a software event, usually available even in VMs) and, optionally, a
+// raw model-specific event such as HITM (cache line found modified in
+// another core — the cost of bouncing an atomic counter).  Pass it as
+// hex through SHPTR_PERF_RAW, e.g. SHPTR_PERF_RAW=0x04d2 for
+// MEM_LOAD_L3_HIT_RETIRED.XSNP_HITM on Skylake.
+//
+// Every counter is opened on its own, so the ones the CPU, hypervisor or
+// perf_event_paranoid refuse are simply reported as "n/a"; on non-Linux
+// systems all of them are.  Counts cover user space of the thread that
+// created the PerfCounters and of threads it starts afterwards, and are
+// scaled if the kernel had to multiplex them.
+// -----------------------------------------------------------------------------
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "bench_util.h"
+#if defined(__linux__)
+  #include <linux/perf_event.h>
+  #include <sys/ioctl.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+namespace bench {
+
+class PerfCounters {
+public:
+    static constexpr int Max = 6;
+
+    PerfCounters() {
+#if defined(__linux__)
+        add("cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        add("instr", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        add("cache-miss", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+        add("L1d-miss", PERF_TYPE_HW_CACHE,
+            PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+        add("ctx-sw", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES);
+        if(const char* raw = std::getenv("SHPTR_PERF_RAW")) add("raw", PERF_TYPE_RAW, std::strtoull(raw, nullptr, 16));
+#else
+        static const char* const names[] = {"cycles", "instr", "cache-miss", "L1d-miss", "ctx-sw"};
+        for(const char* n : names) counters_[n_++] = {n, -1};
+#endif
+    }
+    ~PerfCounters() {
+#if defined(__linux__)
+        for(int i = 0; i < n_; ++i) if(counters_[i].fd >= 0) ::close(counters_[i].fd);
+#endif
+    }
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // true if at least one hardware counter opened
+    bool available() const noexcept {
+        for(int i = 0; i < 4; ++i) if(counters_[i].fd >= 0) return true;
+        return false;
+    }
+
+    void start() noexcept { control(true); }
+    void stop()  noexcept { control(false); }
+
+    // Prints one column per counter: events per operation over `ops`.
+    void print(double ops) const {
+        for(int i = 0; i < n_; ++i) {
+            double v = value(i);
+            if(v < 0) std::printf(" %10s=%-7s", counters_[i].name, "n/a");
+            else      std::printf(" %10s=%-7.2f", counters_[i].name, v / ops);
+        }
+        std::printf("\n");
+    }
+
+private:
+    struct Counter { const char* name; int fd; };
+    Counter counters_[Max];
+    int     n_ = 0;
+
+#if defined(__linux__)
+    void add(const char* name, std::uint32_t type, std::uint64_t config) {
+        perf_event_attr a;
+        std::memset(&a, 0, sizeof a);
+        a.size           = sizeof a;
+        a.type           = type;
+        a.config         = config;
+        a.disabled       = 1;
+        a.exclude_kernel = 1;          // allowed at perf_event_paranoid <= 2
+        a.exclude_hv     = 1;
+        a.inherit        = 1;          // include threads started later
+        a.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        int fd = static_cast<int>(::syscall(SYS_perf_event_open, &a, 0, -1, -1, 0));
+        counters_[n_++] = {name, fd};
+    }
+#endif
+
+    void control(bool on) noexcept {
+#if defined(__linux__)
+        for(int i = 0; i < n_; ++i) {
+            if(counters_[i].fd < 0) continue;
+            if(on) ::ioctl(counters_[i].fd, PERF_EVENT_IOC_RESET, 0);
+            ::ioctl(counters_[i].fd, on ? PERF_EVENT_IOC_ENABLE : PERF_EVENT_IOC_DISABLE, 0);
+        }
+#else
+        (void)on;
+#endif
+    }
+
+    // scaled count, or -1 if the counter is unavailable or never ran
+    double value(int i) const noexcept {
+#if defined(__linux__)
+        std::uint64_t buf[3];   // value, time enabled, time running
+        if(counters_[i].fd < 0 || ::read(counters_[i].fd, buf, sizeof buf)!=static_cast<ssize_t>(sizeof buf) || buf[2]==0) return -1;
+        return static_cast<double>(buf[0]) * static_cast<double>(buf[1]) / static_cast<double>(buf[2]);
+#else
+        (void)i;
+        return -1;
+#endif
+    }
+};
+
+// Like ns_per_op(), but also prints the counters per operation.
+template<class F>
+double perf_row(PerfCounters& pc, const char* name, std::size_t iters, F&& f) {
+    pc.start();
+    double ns = ns_per_op(iters, f);
+    pc.stop();
+    std::printf("%-34s %8.2f ns/op", name, ns);
+    pc.print(static_cast<double>(iters));
+    return ns;
+}
+
+} // namespace bench
+
+#endif // PERF_COUNTERS_H
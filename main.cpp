@@ -5,8 +5,31 @@
 //    g++ -std=c++17 -O2 main.cpp -o demo          # non-atomic counter
 //    g++ -std=c++17 -O2 -DSHPTR_THREADSAFE main.cpp -o demo  # atomic counter
 // -----------------------------------------------------------------------------
+#include <cstdint>      // std::uintptr_t
 #include <iostream>
 #include "SharedPtr.h"
+#include "SharedPool.h"
+#include "SharedQueue.h"
+#include "UniqueShared.h"
+#include "DirectSharedPtr.h"
+#include "Arena.h"
+#include "PmrShared.h"
+#include "LruCache.h"
+#include "InternTable.h"
+#include "CowPtr.h"
+#include "PersistentVector.h"
+#include "PersistentMap.h"
+#include <string>
+#if defined(__unix__) || defined(__APPLE__)
+  #include <cstdio>
+  #include <fstream>
+  #include "MappedArray.h"
+#endif
+#ifdef SHPTR_THREADSAFE
+  #include "LockFreeStack.h"
+  #include "LockFreeQueue.h"
+  #include "ConcurrentMap.h"
+#endif
 
 struct Foo {
     int value;
@@ -38,6 +61,9 @@ void array_demo() {
     std::cout << "\n--- array demo ---\n";
     SharedPtr<int[]> arr(new int[5]{1,2,3,4,5});
     std::cout << "arr[2] = " << arr[2] << "\n";
+    SharedSpan<int> tail = arr.slice(3, 2);             // no copy: shares arr's block
+    arr.reset();
+    std::cout << "slice outlives arr: " << tail[0] << " " << tail[1] << ", size=" << tail.size() << "\n";
 }
 
 void swap_and_move() {
@@ -53,6 +79,208 @@ void swap_and_move() {
     std::cout << "m is " << (m?"not null":"null") << ", n.use_count=" << n.use_count() << "\n";
 }
 
+void pool_demo() {
+    std::cout << "\n--- object pool ---\n";
+    SharedPool<int> pool(4, [](int& v) { v = 0; });
+    int* first;
+    {
+        SharedPtr<int> a = pool.acquire();
+        *a = 5;
+        first = a.get();
+    }
+    SharedPtr<int> b = pool.acquire();
+    std::cout << "recycled=" << (b.get()==first ? "yes" : "no") << " value after reset=" << *b << "\n";
+}
+
+void queue_demo() {
+    std::cout << "\n--- ownership queue ---\n";
+    SharedQueue<SharedPtr<Foo>> q(4);
+    SharedPtr<Foo> in(new Foo{3});
+    q.try_push(in);
+    SharedPtr<Foo> out;
+    q.try_pop(out);
+    std::cout << "in is " << (in?"not null":"null") << ", out.use_count=" << out.use_count() << "\n";
+}
+
+void unique_shared_demo() {
+    std::cout << "\n--- unique → shared promotion ---\n";
+    UniqueShared<Foo> u = make_unique_shared<Foo>(11);
+    u->value = 12;                      // sole owner, no counter traffic
+    Foo* raw = u.get();
+    SharedPtr<Foo> s = std::move(u).share();
+    std::cout << "same object=" << (s.get()==raw ? "yes" : "no") << ", use_count=" << s.use_count() << "\n";
+}
+
+void deleter_alloc_demo() {
+    std::cout << "\n--- custom deleter / allocate_shared_ptr ---\n";
+    int freed = 0;
+    {
+        SharedPtr<Foo> d(new Foo(13), [&freed](Foo* p){ ++freed; delete p; });
+        SharedPtr<Foo> a = allocate_shared_ptr<Foo>(std::allocator<Foo>(), 14);
+        std::cout << "deleter value=" << d->value << ", allocated value=" << a->value << "\n";
+    }
+    std::cout << "deleter ran " << freed << "x\n";
+}
+
+void direct_demo() {
+    std::cout << "\n--- two-word DirectSharedPtr ---\n";
+    SharedPtr<Foo> s(new Foo(15));
+    DirectSharedPtr<Foo> d = s;                 // same block, object pointer cached
+    DirectSharedPtr<int[]> a(new int[3]{1, 2, 3});
+    std::cout << "value=" << d->value << ", a[2]=" << a[2] << ", use_count=" << s.use_count() << "\n";
+    SharedPtr<Foo> back = d.shared();
+    std::cout << "after shared(): use_count=" << back.use_count() << "\n";
+}
+
+void arena_demo() {
+    std::cout << "\n--- per-request arena ---\n";
+    Arena arena;
+    {
+        SharedPtr<Foo> a = make_arena_shared<Foo>(arena, 17);
+        SharedPtr<Foo> b = a;                   // ordinary handles, arena memory
+        std::cout << "value=" << b->value << ", use_count=" << a.use_count()
+                  << ", arena bytes used=" << arena.bytes_used() << "\n";
+    }                                           // ~Foo runs here, memory stays
+    arena.reset();                              // whole request freed at once
+    std::cout << "after reset: bytes used=" << arena.bytes_used() << "\n";
+
+    Arena small(256);
+    small.allocate(250, 1);                     // 6 bytes left, none 64-aligned
+    const std::size_t before = small.bytes_reserved();
+    void* line = small.allocate(8, 64);         // must not land past the chunk
+    std::cout << "64-aligned near chunk end: aligned=" << (reinterpret_cast<std::uintptr_t>(line) % 64==0)
+              << ", new chunk=" << (small.bytes_reserved() > before) << "\n";
+}
+
+void pmr_demo() {
+    std::cout << "\n--- std::pmr resources ---\n";
+    std::pmr::unsynchronized_pool_resource pool;
+    std::pmr::memory_resource* r = &pool;       // could be chosen at run time
+    SharedPtr<Foo> f = make_pmr_shared<Foo>(r, 18);
+    SharedPtr<std::pmr::string> s = make_pmr_shared<std::pmr::string>(r, "block, string and characters from one resource");
+    SharedPtr<int[]> a = make_pmr_shared_array<int>(r, 4);
+    a[3] = f->value;
+    std::cout << "a[3]=" << a[3] << ", string uses pool=" << (s->get_allocator().resource()==r ? "yes" : "no") << "\n";
+}
+
+void lru_demo() {
+    std::cout << "\n--- LruCache ---\n";
+    LruCache<int, Foo> cache(2 * sizeof(Foo), 1);       // room for two
+    cache.insert(1, SharedPtr<Foo>(new Foo(22)));
+    cache.insert(2, SharedPtr<Foo>(new Foo(23)));
+    SharedPtr<Foo> kept = cache.find(1);                // marks 1 as recently used
+    cache.insert(3, SharedPtr<Foo>(new Foo(24)));       // evicts 2
+    LruCacheStats st = cache.stats();
+    std::cout << "has 1=" << !!cache.find(1) << ", has 2=" << !!cache.find(2) << ", kept=" << kept->value
+              << ", hits=" << st.hits << ", evictions=" << st.evictions << "\n";
+}
+
+void intern_demo() {
+    std::cout << "\n--- InternTable ---\n";
+    InternTable<std::string> strings;
+    SharedPtr<const std::string> a = strings.intern(std::string("tier=standard"));
+    SharedPtr<const std::string> b = strings.intern(std::string("tier=standard"));
+    std::cout << "one object=" << (a.get()==b.get()) << ", use_count=" << a.use_count() << ", distinct=" << strings.size();
+    a.reset(); b.reset();                               // the last handle unlists it
+    std::cout << ", after release=" << strings.size() << "\n";
+}
+
+void cow_demo() {
+    std::cout << "\n--- copy on write ---\n";
+    CowPtr<int> a = CowPtr<int>::make(1);
+    CowPtr<int> b = a;
+    b.write() = 2;                      // shared → clones first
+    std::cout << "a=" << a.read() << " b=" << b.read() << ", a.use_count=" << a.use_count() << "\n";
+}
+
+void persistent_vector_demo() {
+    std::cout << "\n--- persistent vector ---\n";
+    PersistentVector<int> v1;
+    for(int i = 0; i < 100; ++i) v1 = v1.push_back(i);
+    PersistentVector<int> v2 = v1.set(50, -1);
+    std::cout << "v1[50]=" << v1[50] << " v2[50]=" << v2[50] << " size=" << v2.size() << "\n";
+}
+
+void persistent_map_demo() {
+    std::cout << "\n--- persistent map ---\n";
+    PersistentMap<std::string, int> routes;
+    routes = routes.insert("a", 1).insert("b", 2);
+    PersistentMap<std::string, int> next = routes.insert("a", 10).erase("b");
+    std::cout << "old a=" << *routes.find("a") << " new a=" << *next.find("a")
+              << ", sizes " << routes.size() << "/" << next.size() << "\n";
+}
+
+struct Link {
+    SharedPtr<Link> next;
+};
+
+void deep_chain_demo() {
+    std::cout << "\n--- deep chain teardown ---\n";
+    const int n = 1000000;
+    SharedPtr<Link> head;
+    for(int i = 0; i < n; ++i) { SharedPtr<Link> l(new Link); l->next = std::move(head); head = std::move(l); }
+    head.reset();                       // iterative: no stack overflow
+    std::cout << "released a chain of " << n << " links\n";
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+void mapped_file_demo() {
+    std::cout << "\n--- memory-mapped array ---\n";
+    const char* path = "shared_ptr_demo.bin";
+    const int values[6] = {10, 20, 30, 40, 50, 60};
+    std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(values), sizeof values);
+
+    SharedSpan<const int> middle;
+    {
+        SharedPtr<const int[]> table = map_file<const int>(path);
+        middle = mapped_span(table).subspan(2, 3);
+    }                                   // the view keeps the mapping alive
+    std::remove(path);
+    std::cout << "mapped view: " << middle[0] << " " << middle[1] << " " << middle[2] << "\n";
+}
+#endif
+
+#ifdef SHPTR_THREADSAFE
+void wait_unique_demo() {
+    std::cout << "\n--- wait_until_unique ---\n";
+    SharedPtr<Foo> p(new Foo(16));
+    std::thread reader([copy = p]() mutable {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        copy.reset();                   // last foreign reference goes away
+    });
+    p.wait_until_unique();              // sleeps instead of spinning on use_count()
+    p->value = 17;                      // sole owner: safe to mutate in place
+    std::cout << "unique again, value=" << p->value << "\n";
+    reader.join();
+}
+
+void lock_free_demo() {
+    std::cout << "\n--- lock-free stack / queue ---\n";
+    LockFreeStack<SharedPtr<Foo>> stack;
+    LockFreeQueue<int> queue;
+    std::thread producer([&] {
+        stack.push(SharedPtr<Foo>(new Foo(19)));
+        for(int i = 1; i <= 3; ++i) queue.push(i);
+    });
+    producer.join();
+    SharedPtr<Foo> top;
+    int first = 0;
+    bool popped = stack.try_pop(top) && queue.try_pop(first);
+    std::cout << "popped=" << popped << ", top=" << top->value << ", first=" << first << "\n";
+}
+
+void concurrent_map_demo() {
+    std::cout << "\n--- ConcurrentMap ---\n";
+    ConcurrentMap<std::string, Foo> cache;
+    cache.insert("a", SharedPtr<Foo>(new Foo(20)));
+    SharedPtr<Foo> held = cache.find("a");
+    std::thread writer([&] { cache.insert_or_assign("a", SharedPtr<Foo>(new Foo(21))); });
+    writer.join();
+    // the replaced Foo(20) lives on in `held`
+    std::cout << "held=" << held->value << ", now=" << cache.find("a")->value << ", size=" << cache.size() << "\n";
+}
+#endif
+
 int main() {
 #ifdef SHPTR_THREADSAFE
     std::cout << "*** Thread‑safe (atomic) build ***\n";
@@ -63,6 +291,27 @@ int main() {
     basic_lifecycle();
     array_demo();
     swap_and_move();
+    pool_demo();
+    queue_demo();
+    unique_shared_demo();
+    deleter_alloc_demo();
+    direct_demo();
+    arena_demo();
+    pmr_demo();
+    lru_demo();
+    intern_demo();
+#ifdef SHPTR_THREADSAFE
+    wait_unique_demo();
+    lock_free_demo();
+    concurrent_map_demo();
+#endif
+    cow_demo();
+    persistent_vector_demo();
+    persistent_map_demo();
+    deep_chain_demo();
+#if defined(__unix__) || defined(__APPLE__)
+    mapped_file_demo();
+#endif
 
     std::cout << "\nAll tests finished.\n" << std::endl;
 }
\ No newline at end of file